@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace inferno
+{
+namespace bench
+{
+// Results are folded into this so the compiler can't drop the work being measured. Atomic since threads add to it too.
+extern std::atomic<uint64_t> g_sink;
+
+inline double now_ns()
+{
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Runs 'fn' 'repetitions' times and returns the fastest run in nanoseconds per operation. 'setup' runs before each repetition and
+// is not timed.
+template <typename SETUP, typename FN>
+double measure(uint32_t repetitions, uint64_t ops, SETUP setup, FN fn)
+{
+    double best = 1e300;
+
+    for (uint32_t i = 0; i < repetitions; i++)
+    {
+        setup();
+
+        double start = now_ns();
+        fn();
+        best = std::min(best, now_ns() - start);
+    }
+
+    return best / double(ops);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// xorshift64*, so every run sees the same keys.
+class Random
+{
+public:
+    Random(uint64_t seed = 0x9e3779b97f4a7c15ull) :
+        m_state(seed ? seed : 1) {}
+
+    inline uint64_t next()
+    {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return m_state * 0x2545f4914f6cdd1dull;
+    }
+
+private:
+    uint64_t m_state;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Returns 'count' random looking keys. The mix is a bijection, so keys from disjoint ranges of 'first' never collide.
+inline std::vector<uint64_t> unique_keys(uint32_t count, uint64_t first)
+{
+    std::vector<uint64_t> keys(count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t x = first + i;
+
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+
+        keys[i] = x ^ (x >> 31);
+    }
+
+    return keys;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Starts 'thread_count' threads running fn(thread_index), releases them all at once and returns the nanoseconds until the last
+// one finished.
+template <typename FN>
+double run_threads(uint32_t thread_count, FN fn)
+{
+    std::atomic<uint32_t>    ready { 0 };
+    std::atomic<bool>        go { false };
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < thread_count; i++)
+    {
+        threads.push_back(std::thread([&, i]() {
+            ready.fetch_add(1);
+
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            fn(i);
+        }));
+    }
+
+    while (ready.load() != thread_count)
+        std::this_thread::yield();
+
+    double start = now_ns();
+    go.store(true, std::memory_order_release);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return now_ns() - start;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+extern void flat_hash_map_benchmark();
+extern void concurrent_hash_map_benchmark();
+extern void fast_hash_benchmark();
+extern void ring_buffer_benchmark();
+} // namespace bench
+} // namespace inferno
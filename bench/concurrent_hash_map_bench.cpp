@@ -0,0 +1,131 @@
+#include "bench.h"
+#include "concurrent_hash_map.h"
+#include <mutex>
+#include <unordered_map>
+
+// Keys every thread reads from. Small enough to stay cache resident, like the pipeline and sampler caches.
+#define CONCURRENT_HASH_MAP_BENCH_KEYS 4096
+#define CONCURRENT_HASH_MAP_BENCH_LOOKUPS (1 << 20)
+// Keys that all threads race to create in the get_or_create() run.
+#define CONCURRENT_HASH_MAP_BENCH_CREATE_KEYS 1024
+// Work done by each create call, roughly the cost of building a cheap object.
+#define CONCURRENT_HASH_MAP_BENCH_CREATE_SPIN 2000
+
+namespace inferno
+{
+namespace bench
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Baseline: the same lookups through a single mutex-guarded std::unordered_map.
+struct LockedMap
+{
+    std::mutex                             mutex;
+    std::unordered_map<uint64_t, uint64_t> map;
+
+    bool get(uint64_t key, uint64_t& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = map.find(key);
+
+        if (it == map.end())
+            return false;
+
+        value = it->second;
+        return true;
+    }
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Every thread looks up CONCURRENT_HASH_MAP_BENCH_LOOKUPS keys of a prefilled map. Returns millions of lookups per second.
+template <typename MAP>
+static double lookups(MAP& map, const std::vector<uint64_t>& keys, uint32_t thread_count)
+{
+    double ns = run_threads(thread_count, [&](uint32_t thread_index) {
+        Random   rng(thread_index + 1);
+        uint64_t sum = 0;
+        uint64_t value;
+
+        for (uint32_t i = 0; i < CONCURRENT_HASH_MAP_BENCH_LOOKUPS; i++)
+        {
+            if (map.get(keys[rng.next() % keys.size()], value))
+                sum += value;
+        }
+
+        g_sink += sum;
+    });
+
+    return double(thread_count) * double(CONCURRENT_HASH_MAP_BENCH_LOOKUPS) / ns * 1000.0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Every thread walks the same keys of an empty map through get_or_create(), starting at a different offset so they collide on
+// keys that are still being built. Returns the milliseconds until all keys exist and checks that each was created exactly once.
+static double create_storm(const std::vector<uint64_t>& keys, uint32_t thread_count, bool& created_once)
+{
+    ConcurrentHashMap<uint64_t, uint64_t> map;
+    std::atomic<uint32_t>                 creates { 0 };
+
+    double ns = run_threads(thread_count, [&](uint32_t thread_index) {
+        uint64_t sum = 0;
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            uint64_t key = keys[(i + thread_index * 7) % keys.size()];
+
+            sum += map.get_or_create(key, [&]() {
+                uint64_t x = key;
+
+                for (uint32_t j = 0; j < CONCURRENT_HASH_MAP_BENCH_CREATE_SPIN; j++)
+                    x = x * 6364136223846793005ull + 1442695040888963407ull;
+
+                creates.fetch_add(1, std::memory_order_relaxed);
+                return x;
+            });
+        }
+
+        g_sink += sum;
+    });
+
+    created_once = creates.load() == keys.size() && map.size() == keys.size();
+
+    return ns / 1000000.0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void concurrent_hash_map_benchmark()
+{
+    const uint32_t thread_counts[] = { 1, 2, 4, 8, 16, 32 };
+
+    std::vector<uint64_t>                 keys = unique_keys(CONCURRENT_HASH_MAP_BENCH_KEYS, 0);
+    ConcurrentHashMap<uint64_t, uint64_t> concurrent_map;
+    LockedMap                             locked_map;
+
+    for (uint64_t key : keys)
+    {
+        concurrent_map.insert(key, key);
+        locked_map.map[key] = key;
+    }
+
+    std::vector<uint64_t> create_keys = unique_keys(CONCURRENT_HASH_MAP_BENCH_CREATE_KEYS, CONCURRENT_HASH_MAP_BENCH_KEYS);
+
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    printf("%8s %24s %24s %18s\n", "threads", "ConcurrentHashMap Mop/s", "mutex + unordered Mop/s", "get_or_create ms");
+
+    for (uint32_t thread_count : thread_counts)
+    {
+        bool   created_once = false;
+        double concurrent   = lookups(concurrent_map, keys, thread_count);
+        double locked       = lookups(locked_map, keys, thread_count);
+        double storm        = create_storm(create_keys, thread_count, created_once);
+
+        printf("%8u %24.1f %24.1f %18.2f%s\n", thread_count, concurrent, locked, storm, created_once ? "" : "  (duplicate creates!)");
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace bench
+} // namespace inferno
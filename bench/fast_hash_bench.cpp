@@ -0,0 +1,112 @@
+#include "bench.h"
+#include "fast_hash.h"
+#include "murmur_hash.h"
+
+// Bytes hashed per measurement of a single input size.
+#define FAST_HASH_BENCH_BYTES (16 << 20)
+#define FAST_HASH_BENCH_BULK_KEYS (1 << 16)
+#define FAST_HASH_BENCH_REPETITIONS 5
+
+namespace inferno
+{
+namespace bench
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Hashes consecutive inputs of 'size' bytes from 'data'. The seed depends on the previous result, so the single-input latency is
+// measured rather than the throughput of independent calls.
+template <typename FN>
+static double latency(const std::vector<uint8_t>& data, uint32_t size, FN fn)
+{
+    uint32_t count = std::max(FAST_HASH_BENCH_BYTES / size, 1u);
+    uint32_t span  = uint32_t(data.size()) - size;
+
+    return measure(
+        FAST_HASH_BENCH_REPETITIONS, count, []() {}, [&]() {
+            uint64_t h      = 0;
+            uint32_t offset = 0;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                h = fn(&data[offset], size, h);
+
+                offset += size;
+
+                if (offset > span)
+                    offset = 0;
+            }
+
+            g_sink += h;
+        });
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Hashes FAST_HASH_BENCH_BULK_KEYS independent keys of 'key_size' bytes, the way a batch of map keys is hashed.
+static void bulk(const std::vector<uint8_t>& data, uint32_t key_size)
+{
+    std::vector<uint64_t> hashes(FAST_HASH_BENCH_BULK_KEYS);
+    uint32_t              count = FAST_HASH_BENCH_BULK_KEYS;
+
+    double murmur = measure(
+        FAST_HASH_BENCH_REPETITIONS, count, []() {}, [&]() {
+            for (uint32_t i = 0; i < count; i++)
+                hashes[i] = murmur_hash_64(&data[i * key_size], key_size, 0);
+
+            g_sink += hashes[count - 1];
+        });
+
+    double single = measure(
+        FAST_HASH_BENCH_REPETITIONS, count, []() {}, [&]() {
+            for (uint32_t i = 0; i < count; i++)
+                hashes[i] = fast_hash(&data[i * key_size], key_size, 0);
+
+            g_sink += hashes[count - 1];
+        });
+
+    double batched = measure(
+        FAST_HASH_BENCH_REPETITIONS, count, []() {}, [&]() {
+            fast_hash_bulk(&data[0], key_size, count, 0, &hashes[0]);
+            g_sink += hashes[count - 1];
+        });
+
+    printf("%8u %12.2f %12.2f %12.2f\n", key_size, murmur, single, batched);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void fast_hash_benchmark()
+{
+    const uint32_t sizes[]     = { 4, 8, 16, 24, 32, 48, 64, 96, 128, 256, 512, 1024, 4096, 65536 };
+    const uint32_t key_sizes[] = { 4, 8, 12, 16 };
+
+    Random               rng;
+    std::vector<uint8_t> data(FAST_HASH_BENCH_BYTES + 65536);
+
+    for (auto& byte : data)
+        byte = uint8_t(rng.next());
+
+    auto murmur = [](const uint8_t* p, uint32_t size, uint64_t seed) { return murmur_hash_64(p, size, seed); };
+    auto fast   = [](const uint8_t* p, uint32_t size, uint64_t seed) { return fast_hash(p, size, seed); };
+
+    printf("Single input, dependent calls, best of %d\n", FAST_HASH_BENCH_REPETITIONS);
+    printf("%8s %12s %12s %12s %12s %8s\n", "bytes", "murmur ns", "fast ns", "murmur GB/s", "fast GB/s", "speedup");
+
+    for (uint32_t size : sizes)
+    {
+        double m = latency(data, size, murmur);
+        double f = latency(data, size, fast);
+
+        printf("%8u %12.2f %12.2f %12.2f %12.2f %7.2fx\n", size, m, f, double(size) / m, double(size) / f, m / f);
+    }
+
+    printf("\n%u independent keys, ns/key\n", FAST_HASH_BENCH_BULK_KEYS);
+    printf("%8s %12s %12s %12s\n", "bytes", "murmur", "fast_hash", "bulk");
+
+    for (uint32_t key_size : key_sizes)
+        bulk(data, key_size);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace bench
+} // namespace inferno
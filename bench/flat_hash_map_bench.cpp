@@ -0,0 +1,92 @@
+#include "bench.h"
+#include "static_hash_map.h"
+#include "flat_hash_map.h"
+#include <memory>
+
+// Slot count of both maps. Large enough that the tables don't fit into L2.
+#define FLAT_HASH_MAP_BENCH_SIZE (1 << 16)
+#define FLAT_HASH_MAP_BENCH_REPETITIONS 5
+
+namespace inferno
+{
+namespace bench
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Measures insert, hit, miss and erase on 'load' * SIZE random 64-bit keys. The map is created once and cleared between runs, the
+// same way the renderer reuses its maps, so page faults on first touch don't end up in the numbers.
+template <typename MAP>
+static void run(const char* name, float load)
+{
+    uint32_t              count  = uint32_t(float(FLAT_HASH_MAP_BENCH_SIZE) * load);
+    std::vector<uint64_t> keys   = unique_keys(count, 0);
+    std::vector<uint64_t> misses = unique_keys(count, count);
+    std::unique_ptr<MAP>  map(new MAP());
+
+    auto fill = [&]() {
+        map->clear();
+
+        for (uint32_t i = 0; i < count; i++)
+            map->set(keys[i], keys[i]);
+    };
+
+    fill();
+
+    double insert = measure(
+        FLAT_HASH_MAP_BENCH_REPETITIONS, count, [&]() { map->clear(); }, [&]() { fill(); });
+
+    double hit = measure(
+        FLAT_HASH_MAP_BENCH_REPETITIONS, count, [&]() {}, [&]() {
+            uint64_t sum = 0;
+            uint64_t value;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (map->get(keys[i], value))
+                    sum += value;
+            }
+
+            g_sink += sum;
+        });
+
+    double miss = measure(
+        FLAT_HASH_MAP_BENCH_REPETITIONS, count, [&]() {}, [&]() {
+            uint64_t found = 0;
+
+            for (uint32_t i = 0; i < count; i++)
+                found += map->has(misses[i]) ? 1 : 0;
+
+            g_sink += found;
+        });
+
+    double erase = measure(
+        FLAT_HASH_MAP_BENCH_REPETITIONS, count, [&]() { fill(); }, [&]() {
+            for (uint32_t i = 0; i < count; i++)
+                map->remove(keys[i]);
+        });
+
+    printf("%-18s %5.1f%% %10.2f %10.2f %10.2f %10.2f\n", name, load * 100.0f, insert, hit, miss, erase);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void flat_hash_map_benchmark()
+{
+    typedef StaticHashMap<uint64_t, uint64_t, FLAT_HASH_MAP_BENCH_SIZE>     ChainedMap;
+    typedef StaticFlatHashMap<uint64_t, uint64_t, FLAT_HASH_MAP_BENCH_SIZE> FlatMap;
+
+    const float loads[] = { 0.25f, 0.5f, 0.75f, 0.875f, 0.95f };
+
+    printf("%d slots, ns/op, best of %d\n", FLAT_HASH_MAP_BENCH_SIZE, FLAT_HASH_MAP_BENCH_REPETITIONS);
+    printf("%-18s %6s %10s %10s %10s %10s\n", "map", "load", "insert", "hit", "miss", "erase");
+
+    for (float load : loads)
+    {
+        run<ChainedMap>("StaticHashMap", load);
+        run<FlatMap>("StaticFlatHashMap", load);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace bench
+} // namespace inferno
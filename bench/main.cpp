@@ -0,0 +1,46 @@
+#include "bench.h"
+#include <string.h>
+
+namespace inferno
+{
+namespace bench
+{
+std::atomic<uint64_t> g_sink { 0 };
+
+struct Benchmark
+{
+    const char* name;
+    void (*run)();
+};
+
+static const Benchmark g_benchmarks[] = {
+    { "flat_hash_map", flat_hash_map_benchmark },
+    { "concurrent_hash_map", concurrent_hash_map_benchmark },
+    { "fast_hash", fast_hash_benchmark },
+    { "ring_buffer", ring_buffer_benchmark }
+};
+} // namespace bench
+} // namespace inferno
+
+// Runs every benchmark, or only the ones named on the command line.
+int main(int argc, char* argv[])
+{
+    using namespace inferno::bench;
+
+    for (const auto& benchmark : g_benchmarks)
+    {
+        bool selected = argc < 2;
+
+        for (int i = 1; i < argc; i++)
+            selected = selected || strcmp(argv[i], benchmark.name) == 0;
+
+        if (!selected)
+            continue;
+
+        printf("=== %s ===\n", benchmark.name);
+        benchmark.run();
+        printf("\n");
+    }
+
+    return 0;
+}
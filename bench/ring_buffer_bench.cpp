@@ -0,0 +1,155 @@
+#include "bench.h"
+#include "ring_buffer.h"
+#include <deque>
+#include <mutex>
+
+#define RING_BUFFER_BENCH_CAPACITY 1024
+#define RING_BUFFER_BENCH_ITEMS (1 << 20)
+// Every this many items carries a timestamp for the latency percentiles. Reading the clock on every item would dominate the
+// throughput numbers.
+#define RING_BUFFER_BENCH_SAMPLE_INTERVAL 64
+
+namespace inferno
+{
+namespace bench
+{
+struct Item
+{
+    uint64_t timestamp; // Push time in nanoseconds, or 0 if the item isn't sampled.
+    uint64_t payload;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Baseline: a bounded std::deque behind a single mutex.
+struct LockedQueue
+{
+    std::mutex       mutex;
+    std::deque<Item> items;
+
+    bool push(const Item& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (items.size() == RING_BUFFER_BENCH_CAPACITY)
+            return false;
+
+        items.push_back(item);
+        return true;
+    }
+
+    bool pop(Item& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (items.empty())
+            return false;
+
+        item = items.front();
+        items.pop_front();
+        return true;
+    }
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static double percentile(std::vector<double>& samples, double p)
+{
+    if (samples.empty())
+        return 0.0;
+
+    size_t index = std::min(size_t(double(samples.size()) * p), samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+    return samples[index];
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Pushes RING_BUFFER_BENCH_ITEMS items through 'queue' with the given numbers of producer and consumer threads. Reports the
+// throughput and the push-to-pop latency of sampled items. Producers push as fast as they can, so the latency includes the time
+// spent in a full queue. Threads yield when the queue is full or empty, so the numbers stay meaningful with more threads than cores.
+template <typename QUEUE>
+static void run(const char* name, QUEUE& queue, uint32_t producers, uint32_t consumers)
+{
+    std::atomic<uint32_t>            consumed { 0 };
+    std::vector<std::vector<double>> latencies(consumers);
+    uint32_t                         per_producer = RING_BUFFER_BENCH_ITEMS / producers;
+    uint32_t                         total        = per_producer * producers;
+
+    double ns = run_threads(producers + consumers, [&](uint32_t thread_index) {
+        if (thread_index < producers)
+        {
+            for (uint32_t i = 0; i < per_producer; i++)
+            {
+                Item item;
+
+                item.timestamp = i % RING_BUFFER_BENCH_SAMPLE_INTERVAL == 0 ? uint64_t(now_ns()) : 0;
+                item.payload   = i;
+
+                while (!queue.push(item))
+                    std::this_thread::yield();
+            }
+        }
+        else
+        {
+            std::vector<double>& samples = latencies[thread_index - producers];
+            uint64_t             sum     = 0;
+            Item                 item;
+
+            while (consumed.load(std::memory_order_relaxed) < total)
+            {
+                if (!queue.pop(item))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if (item.timestamp)
+                    samples.push_back(now_ns() - double(item.timestamp));
+
+                sum += item.payload;
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            g_sink += sum;
+        }
+    });
+
+    std::vector<double> samples;
+
+    for (const auto& consumer_samples : latencies)
+        samples.insert(samples.end(), consumer_samples.begin(), consumer_samples.end());
+
+    double p50 = percentile(samples, 0.5);
+    double p99 = percentile(samples, 0.99);
+
+    printf("%-12s %4u %4u %10.2f %10.0f %10.0f\n", name, producers, consumers, double(total) / ns * 1000.0, p50, p99);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ring_buffer_benchmark()
+{
+    const uint32_t configs[][2] = { { 1, 1 }, { 1, 4 }, { 4, 1 }, { 2, 2 }, { 4, 4 }, { 8, 8 }, { 16, 16 } };
+
+    // Static so the alignment of the cache-line padded members is honoured.
+    static SPSCQueue<Item, RING_BUFFER_BENCH_CAPACITY> spsc;
+    static MPMCQueue<Item, RING_BUFFER_BENCH_CAPACITY> mpmc;
+    static LockedQueue                                 locked;
+
+    printf("%u hardware threads, %d items, capacity %d\n", std::thread::hardware_concurrency(), RING_BUFFER_BENCH_ITEMS, RING_BUFFER_BENCH_CAPACITY);
+    printf("%-12s %4s %4s %10s %10s %10s\n", "queue", "prod", "cons", "Mitems/s", "p50 ns", "p99 ns");
+
+    run("SPSCQueue", spsc, 1, 1);
+
+    for (const auto& config : configs)
+    {
+        run("MPMCQueue", mpmc, config[0], config[1]);
+        run("mutex+deque", locked, config[0], config[1]);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace bench
+} // namespace inferno
@@ -1,4 +1,5 @@
 #include "application.h"
+#include "frame_allocator.h"
 #include "utility.h"
 #include <iostream>
 
@@ -180,6 +181,8 @@ void Application::begin_frame()
 {
     m_timer.start();
 
+    frame_allocator::next_frame();
+
     glfwPollEvents();
 
     /*  ImGui_ImplOpenGL3_NewFrame();
@@ -0,0 +1,378 @@
+#include "async_compute.h"
+#include "logger.h"
+#include "macros.h"
+#include <algorithm>
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Mask of the bits of a timestamp that the queue family actually writes.
+static uint64_t timestamp_mask(uint32_t valid_bits)
+{
+    return valid_bits >= 64 ? UINT64_MAX : (uint64_t(1) << valid_bits) - 1;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Signed difference 'to' - 'from' in ticks, taking wrap-around of the valid bits into account. Differences of more than half the
+// range are taken to be negative.
+static double timestamp_delta(uint64_t from, uint64_t to, uint64_t mask)
+{
+    uint64_t delta = (to - from) & mask;
+
+    if (delta > (mask >> 1))
+        return -double((from - to) & mask);
+
+    return double(delta);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+AsyncCompute::Ptr AsyncCompute::create(Backend::Ptr backend)
+{
+    return std::shared_ptr<AsyncCompute>(new AsyncCompute(backend));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+AsyncCompute::AsyncCompute(Backend::Ptr backend) :
+    Object(backend)
+{
+    QueueInfos& queues = backend->queue_infos();
+
+    m_vk_compute_queue = backend->compute_queue();
+    m_asynchronous     = queues.asynchronous_compute();
+    m_command_pool     = CommandPool::create(backend, queues.compute_queue_index);
+
+    // Timestamps are only usable if both the compute and the graphics family support them.
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(backend->physical_device(), &properties);
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(backend->physical_device(), &family_count, nullptr);
+
+    FrameVector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(backend->physical_device(), &family_count, families.data());
+
+    uint32_t compute_bits  = families[queues.compute_queue_index].timestampValidBits;
+    uint32_t graphics_bits = families[queues.graphics_queue_index].timestampValidBits;
+
+    m_timestamp_period       = properties.limits.timestampPeriod;
+    m_timestamps             = compute_bits > 0 && graphics_bits > 0;
+    m_compute_timestamp_mask = timestamp_mask(compute_bits);
+    m_shared_timestamp_mask  = timestamp_mask(std::min(compute_bits, graphics_bits));
+
+    if (m_timestamps)
+    {
+        VkQueryPoolCreateInfo query_pool_info;
+        INFERNO_ZERO_MEMORY(query_pool_info);
+
+        query_pool_info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        query_pool_info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+        query_pool_info.queryCount = ASYNC_COMPUTE_MAX_IN_FLIGHT * QUERY_COUNT;
+
+        if (vkCreateQueryPool(m_vk_device, &query_pool_info, nullptr, &m_vk_query_pool) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create Query Pool.");
+            throw std::runtime_error("(Vulkan) Failed to create Query Pool.");
+        }
+    }
+    else
+        INFERNO_LOG_WARNING("(Vulkan) Timestamps not supported on the compute and graphics queues, async compute overlap can't be measured.");
+
+    VkFenceCreateInfo fence_info;
+    INFERNO_ZERO_MEMORY(fence_info);
+
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphore_info;
+    INFERNO_ZERO_MEMORY(semaphore_info);
+
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (auto& submission : m_submissions)
+    {
+        submission.cmd = CommandBuffer::create(backend, m_command_pool);
+
+        if (vkCreateFence(m_vk_device, &fence_info, nullptr, &submission.vk_fence) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create Fence.");
+            throw std::runtime_error("(Vulkan) Failed to create Fence.");
+        }
+
+        if (vkCreateSemaphore(m_vk_device, &semaphore_info, nullptr, &submission.vk_semaphore) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create Semaphore.");
+            throw std::runtime_error("(Vulkan) Failed to create Semaphore.");
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+AsyncCompute::~AsyncCompute()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+
+    while (retire_oldest(true))
+        ;
+
+    for (auto& submission : m_submissions)
+    {
+        if (submission.vk_fence)
+            vkDestroyFence(m_vk_device, submission.vk_fence, nullptr);
+
+        if (submission.vk_semaphore)
+            vkDestroySemaphore(m_vk_device, submission.vk_semaphore, nullptr);
+    }
+
+    if (m_vk_query_pool)
+        vkDestroyQueryPool(m_vk_device, m_vk_query_pool, nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkCommandBuffer AsyncCompute::begin()
+{
+    if (m_recording)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) AsyncCompute::begin() called twice without submit().");
+        throw std::runtime_error("(Vulkan) AsyncCompute::begin() called twice without submit().");
+    }
+
+    Submission& s = submission(m_next_token);
+
+    while (m_completed_token < s.token)
+        retire_oldest(true);
+
+    // A binary semaphore can't be signalled again until its previous signal has been waited on.
+    if (s.signalled)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Async compute results were never consumed by the graphics queue.");
+        throw std::runtime_error("(Vulkan) Async compute results were never consumed by the graphics queue.");
+    }
+
+    s.cmd->reset();
+    s.wait_semaphores.clear();
+    s.wait_stages.clear();
+    s.graphics_begin_marked = false;
+    s.graphics_end_marked   = false;
+
+    VkCommandBufferBeginInfo begin_info;
+    INFERNO_ZERO_MEMORY(begin_info);
+
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(s.cmd->handle(), &begin_info) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to begin Command Buffer.");
+        throw std::runtime_error("(Vulkan) Failed to begin Command Buffer.");
+    }
+
+    if (m_timestamps)
+    {
+        vkCmdResetQueryPool(s.cmd->handle(), m_vk_query_pool, first_query(m_next_token) + QUERY_COMPUTE_BEGIN, 2);
+        vkCmdWriteTimestamp(s.cmd->handle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_vk_query_pool, first_query(m_next_token) + QUERY_COMPUTE_BEGIN);
+    }
+
+    m_recording = true;
+
+    return s.cmd->handle();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void AsyncCompute::wait_semaphore(VkSemaphore semaphore, VkPipelineStageFlags stage)
+{
+    Submission& s = submission(m_next_token);
+
+    s.wait_semaphores.push_back(semaphore);
+    s.wait_stages.push_back(stage);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+ComputeToken AsyncCompute::submit(VkPipelineStageFlags consumer_stage)
+{
+    if (!m_recording)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) AsyncCompute::submit() called without begin().");
+        throw std::runtime_error("(Vulkan) AsyncCompute::submit() called without begin().");
+    }
+
+    Submission&     s   = submission(m_next_token);
+    VkCommandBuffer cmd = s.cmd->handle();
+
+    if (m_timestamps)
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_vk_query_pool, first_query(m_next_token) + QUERY_COMPUTE_END);
+
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to end Command Buffer.");
+        throw std::runtime_error("(Vulkan) Failed to end Command Buffer.");
+    }
+
+    VkSubmitInfo submit_info;
+    INFERNO_ZERO_MEMORY(submit_info);
+
+    submit_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.waitSemaphoreCount = s.wait_semaphores.size();
+    submit_info.pWaitSemaphores    = s.wait_semaphores.data();
+    submit_info.pWaitDstStageMask  = s.wait_stages.data();
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers    = &cmd;
+
+    if (consumer_stage != 0)
+    {
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores    = &s.vk_semaphore;
+    }
+
+    vkResetFences(m_vk_device, 1, &s.vk_fence);
+
+    if (vkQueueSubmit(m_vk_compute_queue, 1, &submit_info, s.vk_fence) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to submit async compute work.");
+        throw std::runtime_error("(Vulkan) Failed to submit async compute work.");
+    }
+
+    s.token          = m_next_token++;
+    s.signalled      = consumer_stage != 0;
+    s.consumer_stage = consumer_stage;
+    m_recording      = false;
+
+    return s.token;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void AsyncCompute::consume(ComputeToken token, FrameVector<VkSemaphore>& wait_semaphores, FrameVector<VkPipelineStageFlags>& wait_stages)
+{
+    Submission& s = submission(token);
+
+    if (s.token != token || !s.signalled)
+        return;
+
+    wait_semaphores.push_back(s.vk_semaphore);
+    wait_stages.push_back(s.consumer_stage);
+
+    s.signalled = false;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool AsyncCompute::is_complete(ComputeToken token)
+{
+    while (m_completed_token < token && retire_oldest(false))
+        ;
+
+    return m_completed_token >= token;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void AsyncCompute::wait(ComputeToken token)
+{
+    while (m_completed_token < token && retire_oldest(true))
+        ;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void AsyncCompute::mark_graphics_begin(VkCommandBuffer cmd, ComputeToken token)
+{
+    Submission& s = submission(token);
+
+    if (!m_timestamps || s.token != token)
+        return;
+
+    vkCmdResetQueryPool(cmd, m_vk_query_pool, first_query(token) + QUERY_GRAPHICS_BEGIN, 2);
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_vk_query_pool, first_query(token) + QUERY_GRAPHICS_BEGIN);
+
+    s.graphics_begin_marked = true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void AsyncCompute::mark_graphics_end(VkCommandBuffer cmd, ComputeToken token)
+{
+    Submission& s = submission(token);
+
+    // Without the begin mark the end query was never reset.
+    if (!m_timestamps || s.token != token || !s.graphics_begin_marked)
+        return;
+
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_vk_query_pool, first_query(token) + QUERY_GRAPHICS_END);
+
+    s.graphics_end_marked = true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool AsyncCompute::timing(ComputeToken token, ComputeTiming& timing)
+{
+    Submission& s = submission(token);
+
+    if (!m_timestamps || s.token != token)
+        return false;
+
+    // Graphics queries that were never written would never become available, so they are only read if both marks were recorded.
+    bool     graphics    = s.graphics_begin_marked && s.graphics_end_marked;
+    uint32_t query_count = graphics ? uint32_t(QUERY_COUNT) : uint32_t(QUERY_GRAPHICS_BEGIN);
+    uint64_t timestamps[QUERY_COUNT];
+
+    if (vkGetQueryPoolResults(m_vk_device, m_vk_query_pool, first_query(token), query_count, sizeof(uint64_t) * query_count, &timestamps[0], sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+        return false;
+
+    double   to_ms = m_timestamp_period / 1000000.0;
+    uint64_t begin = timestamps[QUERY_COMPUTE_BEGIN];
+
+    timing.compute_ms = timestamp_delta(begin, timestamps[QUERY_COMPUTE_END], m_compute_timestamp_mask) * to_ms;
+    timing.graphics   = graphics;
+
+    if (graphics)
+    {
+        timing.graphics_begin_ms = timestamp_delta(begin, timestamps[QUERY_GRAPHICS_BEGIN], m_shared_timestamp_mask) * to_ms;
+        timing.graphics_end_ms   = timestamp_delta(begin, timestamps[QUERY_GRAPHICS_END], m_shared_timestamp_mask) * to_ms;
+        timing.overlap_ms        = std::max(0.0, std::min(timing.compute_ms, timing.graphics_end_ms) - std::max(0.0, timing.graphics_begin_ms));
+    }
+    else
+    {
+        timing.graphics_begin_ms = 0.0;
+        timing.graphics_end_ms   = 0.0;
+        timing.overlap_ms        = 0.0;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool AsyncCompute::retire_oldest(bool block)
+{
+    if (m_completed_token + 1 >= m_next_token)
+        return false;
+
+    Submission& s = submission(m_completed_token + 1);
+
+    if (block)
+        vkWaitForFences(m_vk_device, 1, &s.vk_fence, VK_TRUE, UINT64_MAX);
+    else if (vkGetFenceStatus(m_vk_device, s.vk_fence) != VK_SUCCESS)
+        return false;
+
+    m_completed_token = s.token;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
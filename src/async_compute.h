@@ -0,0 +1,126 @@
+#pragma once
+
+#include "vk.h"
+#include "frame_allocator.h"
+#include "small_vector.h"
+#include <stdint.h>
+
+// Number of compute submissions that can be in flight at once.
+#define ASYNC_COMPUTE_MAX_IN_FLIGHT 8
+#define ASYNC_COMPUTE_MAX_WAITS 4
+
+namespace inferno
+{
+namespace vk
+{
+// Returned by AsyncCompute::submit(). Tokens increase monotonically.
+using ComputeToken = uint64_t;
+
+// GPU timings of one compute submission and the graphics work it was measured against, in milliseconds relative to the start of
+// the compute work. If the graphics work wasn't bracketed with mark_graphics_begin() and mark_graphics_end(), only compute_ms is
+// filled in and 'graphics' is false.
+struct ComputeTiming
+{
+    double compute_ms;
+    double graphics_begin_ms;
+    double graphics_end_ms;
+    double overlap_ms;
+    bool   graphics;
+};
+
+// Schedules compute work such as culling, Hi-Z generation, light clustering or probe filtering on the dedicated compute queue so
+// that it runs alongside graphics work. Falls back to the graphics queue if the device has no separate compute family, in which
+// case everything still works but nothing overlaps.
+//
+//     VkCommandBuffer cmd = compute->begin();
+//     compute->wait_semaphore(depth_ready, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);   // Optional, e.g. Hi-Z reading this frame's depth.
+//     ... record dispatches ...
+//     ComputeToken token = compute->submit(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT);     // Stage of the graphics work consuming the results.
+//     ...
+//     compute->consume(token, wait_semaphores, wait_stages);                          // Graphics submission waits on these.
+//
+// The graphics queue only waits at the consuming stage, so everything before it overlaps with the compute work. Resources shared
+// between the two families either need VK_SHARING_MODE_CONCURRENT or ownership transfer barriers recorded by the caller.
+//
+// Overlap can be measured by bracketing the graphics work with mark_graphics_begin() and mark_graphics_end(), then reading the
+// result with timing() once the submission has completed. This compares timestamps from two queues directly, which assumes they
+// share one clock as they do on desktop GPUs. Not thread-safe.
+class AsyncCompute : public Object
+{
+public:
+    using Ptr = std::shared_ptr<AsyncCompute>;
+
+    static AsyncCompute::Ptr create(Backend::Ptr backend);
+
+    ~AsyncCompute();
+
+    // Starts recording a new submission and returns its command buffer. Waits if the oldest submission is still executing.
+    VkCommandBuffer begin();
+
+    // Makes the submission being recorded wait on 'semaphore' at 'stage', e.g. for work produced by the graphics queue.
+    void wait_semaphore(VkSemaphore semaphore, VkPipelineStageFlags stage);
+
+    // Submits the recorded work. 'consumer_stage' is the graphics pipeline stage that reads the results, or 0 if nothing on the
+    // graphics queue waits for them, in which case no semaphore is signalled.
+    ComputeToken submit(VkPipelineStageFlags consumer_stage);
+
+    // Adds the semaphore of 'token' to a graphics submission. Each token with a consumer stage must be consumed exactly once.
+    void consume(ComputeToken token, FrameVector<VkSemaphore>& wait_semaphores, FrameVector<VkPipelineStageFlags>& wait_stages);
+
+    bool is_complete(ComputeToken token);
+    void wait(ComputeToken token);
+
+    // Write timestamps around the graphics work that should overlap with 'token'. Must be recorded outside of a render pass.
+    void mark_graphics_begin(VkCommandBuffer cmd, ComputeToken token);
+    void mark_graphics_end(VkCommandBuffer cmd, ComputeToken token);
+
+    // Returns false until the compute work, and the graphics timestamps if both were recorded, are available.
+    bool timing(ComputeToken token, ComputeTiming& timing);
+
+    inline bool asynchronous() { return m_asynchronous; }
+
+private:
+    enum Query
+    {
+        QUERY_COMPUTE_BEGIN = 0,
+        QUERY_COMPUTE_END,
+        QUERY_GRAPHICS_BEGIN,
+        QUERY_GRAPHICS_END,
+        QUERY_COUNT
+    };
+
+    struct Submission
+    {
+        CommandBuffer::Ptr                                         cmd;
+        VkFence                                                    vk_fence              = nullptr;
+        VkSemaphore                                                vk_semaphore          = nullptr;
+        ComputeToken                                               token                 = 0;
+        bool                                                       signalled             = false;
+        bool                                                       graphics_begin_marked = false;
+        bool                                                       graphics_end_marked   = false;
+        SmallVector<VkSemaphore, ASYNC_COMPUTE_MAX_WAITS>          wait_semaphores;
+        SmallVector<VkPipelineStageFlags, ASYNC_COMPUTE_MAX_WAITS> wait_stages;
+        VkPipelineStageFlags                                       consumer_stage = 0;
+    };
+
+    AsyncCompute(Backend::Ptr backend);
+    inline Submission& submission(ComputeToken token) { return m_submissions[token % ASYNC_COMPUTE_MAX_IN_FLIGHT]; }
+    inline uint32_t    first_query(ComputeToken token) { return uint32_t(token % ASYNC_COMPUTE_MAX_IN_FLIGHT) * QUERY_COUNT; }
+    bool               retire_oldest(bool block);
+
+private:
+    VkQueue          m_vk_compute_queue;
+    VkQueryPool      m_vk_query_pool = nullptr;
+    bool             m_asynchronous;
+    bool             m_timestamps;
+    double           m_timestamp_period;
+    uint64_t         m_compute_timestamp_mask;
+    uint64_t         m_shared_timestamp_mask;
+    CommandPool::Ptr m_command_pool;
+    Submission       m_submissions[ASYNC_COMPUTE_MAX_IN_FLIGHT];
+    ComputeToken     m_next_token      = 1;
+    ComputeToken     m_completed_token = 0;
+    bool             m_recording       = false;
+};
+} // namespace vk
+} // namespace inferno
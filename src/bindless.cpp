@@ -0,0 +1,282 @@
+#include "bindless.h"
+#include "logger.h"
+#include "macros.h"
+#include <algorithm>
+#include <string>
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t BindlessDescriptors::SlotAllocator::allocate()
+{
+    uint32_t index;
+
+    if (!free.empty())
+    {
+        index = free.back();
+        free.pop_back();
+    }
+    else if (next < capacity)
+    {
+        index = next++;
+        allocated.push_back(false);
+    }
+    else
+        return BINDLESS_INVALID_INDEX;
+
+    allocated[index] = true;
+
+    return index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool BindlessDescriptors::SlotAllocator::release(uint32_t index, uint64_t frame)
+{
+    // Anything else would put a slot on the free list that was never handed out, or put the same slot on it twice.
+    if (index == BINDLESS_INVALID_INDEX || index >= next || !allocated[index])
+        return false;
+
+    allocated[index] = false;
+    pending.push_back({ index, frame });
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BindlessDescriptors::SlotAllocator::recycle(uint64_t frame, uint32_t frames_in_flight)
+{
+    // Released in frame order, so everything old enough is at the front.
+    size_t count = 0;
+
+    while (count < pending.size() && pending[count].frame + frames_in_flight <= frame)
+        free.push_back(pending[count++].index);
+
+    pending.erase(pending.begin(), pending.begin() + count);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void check_limit(const char* name, uint32_t requested, uint32_t limit)
+{
+    if (requested > limit)
+    {
+        std::string message = std::string("(Vulkan) Bindless ") + name + " count " + std::to_string(requested) + " exceeds the device limit of " + std::to_string(limit) + ".";
+
+        INFERNO_LOG_FATAL(message);
+        throw std::runtime_error(message);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+BindlessDescriptors::Ptr BindlessDescriptors::create(Backend::Ptr backend, uint32_t max_sampled_images, uint32_t max_samplers, uint32_t max_storage_buffers)
+{
+    return std::shared_ptr<BindlessDescriptors>(new BindlessDescriptors(backend, max_sampled_images, max_samplers, max_storage_buffers));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+BindlessDescriptors::BindlessDescriptors(Backend::Ptr backend, uint32_t max_sampled_images, uint32_t max_samplers, uint32_t max_storage_buffers) :
+    Object(backend)
+{
+    if (!backend->descriptor_indexing())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Bindless descriptors require descriptor indexing.");
+        throw std::runtime_error("(Vulkan) Bindless descriptors require descriptor indexing.");
+    }
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexing_properties;
+    INFERNO_ZERO_MEMORY(indexing_properties);
+
+    indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+
+    VkPhysicalDeviceProperties2 properties2;
+    INFERNO_ZERO_MEMORY(properties2);
+
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &indexing_properties;
+
+    vkGetPhysicalDeviceProperties2(backend->physical_device(), &properties2);
+
+    // Every binding is visible to all stages, so the per-stage limits apply on top of the per-set ones.
+    check_limit("sampled image", max_sampled_images, std::min(indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages, indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages));
+    check_limit("sampler", max_samplers, std::min(indexing_properties.maxDescriptorSetUpdateAfterBindSamplers, indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers));
+    check_limit("storage buffer", max_storage_buffers, std::min(indexing_properties.maxDescriptorSetUpdateAfterBindStorageBuffers, indexing_properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers));
+    check_limit("per-stage resource", uint32_t(std::min(uint64_t(max_sampled_images) + max_storage_buffers, uint64_t(UINT32_MAX))), indexing_properties.maxPerStageUpdateAfterBindResources);
+
+    m_frames_in_flight         = backend->frames_in_flight();
+    m_sampled_images.capacity  = max_sampled_images;
+    m_samplers.capacity        = max_samplers;
+    m_storage_buffers.capacity = max_storage_buffers;
+
+    VkDescriptorBindingFlagsEXT binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+
+    DescriptorSetLayout::Desc layout_desc;
+
+    layout_desc.set_flags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT);
+    layout_desc.add_binding(BINDLESS_SAMPLED_IMAGE_BINDING, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, max_sampled_images, VK_SHADER_STAGE_ALL);
+    layout_desc.add_binding(BINDLESS_SAMPLER_BINDING, VK_DESCRIPTOR_TYPE_SAMPLER, max_samplers, VK_SHADER_STAGE_ALL);
+    layout_desc.add_binding(BINDLESS_STORAGE_BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, max_storage_buffers, VK_SHADER_STAGE_ALL);
+    layout_desc.set_binding_flags(BINDLESS_SAMPLED_IMAGE_BINDING, binding_flags);
+    layout_desc.set_binding_flags(BINDLESS_SAMPLER_BINDING, binding_flags);
+    layout_desc.set_binding_flags(BINDLESS_STORAGE_BUFFER_BINDING, binding_flags);
+
+    m_layout = DescriptorSetLayout::create(backend, layout_desc);
+
+    DescriptorPool::Desc pool_desc;
+
+    pool_desc.set_flags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT);
+    pool_desc.set_max_sets(1);
+    pool_desc.add_pool_size(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, max_sampled_images);
+    pool_desc.add_pool_size(VK_DESCRIPTOR_TYPE_SAMPLER, max_samplers);
+    pool_desc.add_pool_size(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, max_storage_buffers);
+
+    m_pool = DescriptorPool::create(backend, pool_desc);
+    m_set  = DescriptorSet::create(backend, m_layout, m_pool);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+BindlessDescriptors::~BindlessDescriptors()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+
+    // The set has to go before the pool it was allocated from.
+    m_set.reset();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BindlessDescriptors::begin_frame(const FrameContext& frame)
+{
+    m_frame_number = frame.frame_number;
+
+    m_sampled_images.recycle(m_frame_number, m_frames_in_flight);
+    m_samplers.recycle(m_frame_number, m_frames_in_flight);
+    m_storage_buffers.recycle(m_frame_number, m_frames_in_flight);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t BindlessDescriptors::add_sampled_image(ImageView* view, VkImageLayout layout)
+{
+    uint32_t index = m_sampled_images.allocate();
+
+    if (index == BINDLESS_INVALID_INDEX)
+    {
+        INFERNO_LOG_ERROR("(Vulkan) Out of bindless sampled image slots.");
+        return index;
+    }
+
+    VkDescriptorImageInfo image_info;
+
+    image_info.sampler     = nullptr;
+    image_info.imageView   = view->handle();
+    image_info.imageLayout = layout;
+
+    write(BINDLESS_SAMPLED_IMAGE_BINDING, index, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, &image_info, nullptr);
+
+    return index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t BindlessDescriptors::add_sampler(Sampler* sampler)
+{
+    uint32_t index = m_samplers.allocate();
+
+    if (index == BINDLESS_INVALID_INDEX)
+    {
+        INFERNO_LOG_ERROR("(Vulkan) Out of bindless sampler slots.");
+        return index;
+    }
+
+    VkDescriptorImageInfo image_info;
+
+    image_info.sampler     = sampler->handle();
+    image_info.imageView   = nullptr;
+    image_info.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    write(BINDLESS_SAMPLER_BINDING, index, VK_DESCRIPTOR_TYPE_SAMPLER, &image_info, nullptr);
+
+    return index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t BindlessDescriptors::add_storage_buffer(Buffer* buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    uint32_t index = m_storage_buffers.allocate();
+
+    if (index == BINDLESS_INVALID_INDEX)
+    {
+        INFERNO_LOG_ERROR("(Vulkan) Out of bindless storage buffer slots.");
+        return index;
+    }
+
+    VkDescriptorBufferInfo buffer_info;
+
+    buffer_info.buffer = buffer->handle();
+    buffer_info.offset = offset;
+    buffer_info.range  = range;
+
+    write(BINDLESS_STORAGE_BUFFER_BINDING, index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &buffer_info);
+
+    return index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BindlessDescriptors::remove_sampled_image(uint32_t index)
+{
+    if (!m_sampled_images.release(index, m_frame_number))
+        INFERNO_LOG_ERROR("(Vulkan) Removing invalid or already removed bindless sampled image index " + std::to_string(index) + ".");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BindlessDescriptors::remove_sampler(uint32_t index)
+{
+    if (!m_samplers.release(index, m_frame_number))
+        INFERNO_LOG_ERROR("(Vulkan) Removing invalid or already removed bindless sampler index " + std::to_string(index) + ".");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BindlessDescriptors::remove_storage_buffer(uint32_t index)
+{
+    if (!m_storage_buffers.release(index, m_frame_number))
+        INFERNO_LOG_ERROR("(Vulkan) Removing invalid or already removed bindless storage buffer index " + std::to_string(index) + ".");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BindlessDescriptors::write(uint32_t binding, uint32_t index, VkDescriptorType type, const VkDescriptorImageInfo* image_info, const VkDescriptorBufferInfo* buffer_info)
+{
+    VkWriteDescriptorSet write;
+    INFERNO_ZERO_MEMORY(write);
+
+    write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet          = m_set->handle();
+    write.dstBinding      = binding;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType  = type;
+    write.pImageInfo      = image_info;
+    write.pBufferInfo     = buffer_info;
+
+    vkUpdateDescriptorSets(m_vk_device, 1, &write, 0, nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
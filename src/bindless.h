@@ -0,0 +1,88 @@
+#pragma once
+
+#include "vk.h"
+#include <stdint.h>
+#include <vector>
+
+#define BINDLESS_SAMPLED_IMAGE_BINDING 0
+#define BINDLESS_SAMPLER_BINDING 1
+#define BINDLESS_STORAGE_BUFFER_BINDING 2
+
+#define BINDLESS_INVALID_INDEX 0xffffffffu
+
+namespace inferno
+{
+namespace vk
+{
+// One global descriptor set holding large, partially bound arrays of sampled images, samplers and storage buffers. Resources are
+// added once and referenced by index from materials or GPU-driven draw data, so a frame binds a single set instead of one per
+// material:
+//
+//     layout(set = 0, binding = 0) uniform texture2D textures[];
+//     layout(set = 0, binding = 1) uniform sampler samplers[];
+//     layout(set = 0, binding = 2) buffer Buffers { uint data[]; } buffers[];
+//
+//     texture(sampler2D(textures[nonuniformEXT(material.albedo)], samplers[material.sampler]), uv);
+//
+// The arrays are update-after-bind, so indices can be added while the set is bound by frames in flight. Removed indices are only
+// handed out again once those frames have completed. Requires Backend::descriptor_indexing(). Not thread-safe.
+class BindlessDescriptors : public Object
+{
+public:
+    using Ptr = std::shared_ptr<BindlessDescriptors>;
+
+    static BindlessDescriptors::Ptr create(Backend::Ptr backend, uint32_t max_sampled_images, uint32_t max_samplers, uint32_t max_storage_buffers);
+
+    ~BindlessDescriptors();
+
+    // Call once per frame after Backend::begin_frame() to recycle indices that are no longer in use by the GPU.
+    void begin_frame(const FrameContext& frame);
+
+    uint32_t add_sampled_image(ImageView* view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t add_sampler(Sampler* sampler);
+    uint32_t add_storage_buffer(Buffer* buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+    // Indices that were never handed out, BINDLESS_INVALID_INDEX and indices that were already removed are rejected with an error.
+    void remove_sampled_image(uint32_t index);
+    void remove_sampler(uint32_t index);
+    void remove_storage_buffer(uint32_t index);
+
+    inline DescriptorSetLayout::Ptr layout() { return m_layout; }
+    inline VkDescriptorSet          handle() { return m_set->handle(); }
+
+private:
+    // Free-list slot allocator for one array. Released slots wait for the frames in flight before they are reused.
+    struct SlotAllocator
+    {
+        struct Pending
+        {
+            uint32_t index;
+            uint64_t frame;
+        };
+
+        uint32_t              capacity = 0;
+        uint32_t              next     = 0;
+        std::vector<uint32_t> free;
+        std::vector<Pending>  pending;
+        std::vector<bool>     allocated;
+
+        uint32_t allocate();
+        bool     release(uint32_t index, uint64_t frame);
+        void     recycle(uint64_t frame, uint32_t frames_in_flight);
+    };
+
+    BindlessDescriptors(Backend::Ptr backend, uint32_t max_sampled_images, uint32_t max_samplers, uint32_t max_storage_buffers);
+    void write(uint32_t binding, uint32_t index, VkDescriptorType type, const VkDescriptorImageInfo* image_info, const VkDescriptorBufferInfo* buffer_info);
+
+private:
+    DescriptorSetLayout::Ptr m_layout;
+    DescriptorPool::Ptr      m_pool;
+    DescriptorSet::Ptr       m_set;
+    SlotAllocator            m_sampled_images;
+    SlotAllocator            m_samplers;
+    SlotAllocator            m_storage_buffers;
+    uint32_t                 m_frames_in_flight;
+    uint64_t                 m_frame_number = 0;
+};
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,210 @@
+#include "cascaded_shadow_map.h"
+#include "camera.h"
+#include "entity.h"
+#include <gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <float.h>
+
+// Granularity at which the cascade window shrinks towards the receivers. Must be even so the grid stays centered.
+#define CSM_TIGHTEN_STEPS 16
+
+namespace inferno
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Same as intersects(Frustum, OBB) but ignores the near plane, since casters between the light and the cascade still cast into it.
+static bool intersects_caster_volume(const Frustum& frustum, const OBB& obb)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        if (i == FRUSTUM_PLANE_NEAR)
+            continue;
+
+        if (classify(obb, frustum.planes[i]) < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void compute_cascade_splits(const Camera& camera, uint32_t cascade_count, float lambda, float* splits)
+{
+    float near_plane = camera.m_near;
+    float far_plane  = camera.m_far;
+    float ratio      = far_plane / near_plane;
+    float range      = far_plane - near_plane;
+
+    splits[0] = near_plane;
+
+    for (uint32_t i = 1; i < cascade_count; i++)
+    {
+        float p             = float(i) / float(cascade_count);
+        float log_split     = near_plane * powf(ratio, p);
+        float uniform_split = near_plane + range * p;
+
+        splits[i] = lambda * log_split + (1.0f - lambda) * uniform_split;
+    }
+
+    splits[cascade_count] = far_plane;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void update_cascades(CascadedShadowMap& csm, const Camera& camera, const glm::vec3& light_direction, Entity* entities, uint32_t entity_count, uint32_t camera_view_index)
+{
+    uint32_t cascade_count = std::min(csm.cascade_count, uint32_t(MAX_SHADOW_MAP_CASCADES));
+
+    // Every cascade needs its own bit in the 64-bit visibility flags.
+    cascade_count = std::min(cascade_count, csm.view_index_base < 64 ? 64 - csm.view_index_base : 0);
+
+    compute_cascade_splits(camera, cascade_count, csm.lambda, csm.split_distances);
+
+    glm::vec3 dir = glm::normalize(light_direction);
+    glm::vec3 up  = fabsf(glm::dot(dir, glm::vec3(0.0f, 1.0f, 0.0f))) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    for (uint32_t i = 0; i < cascade_count; i++)
+    {
+        // Slice the camera frustum between the two split distances.
+        glm::mat4 slice_projection      = glm::perspective(glm::radians(camera.m_fov), camera.m_aspect_ratio, csm.split_distances[i], csm.split_distances[i + 1]);
+        glm::mat4 slice_view_projection = slice_projection * camera.m_view;
+
+        glm::vec3 corners[8];
+        extract_frustum_corners(glm::inverse(slice_view_projection), corners);
+
+        Frustum slice_frustum;
+        frustum_from_matrix(slice_frustum, slice_view_projection);
+
+        // Fit a sphere around the slice so the cascade size doesn't change as the camera rotates.
+        glm::vec3 center = glm::vec3(0.0f);
+
+        for (int j = 0; j < 8; j++)
+            center += corners[j];
+
+        center /= 8.0f;
+
+        float radius = 0.0f;
+
+        for (int j = 0; j < 8; j++)
+            radius = std::max(radius, glm::length(corners[j] - center));
+
+        radius = ceilf(radius * 16.0f) / 16.0f;
+
+        glm::mat4 light_view = glm::lookAt(center, center + dir, up);
+
+        // Gather the bounds of the receivers that are visible from the camera and fall within this slice.
+        glm::vec3 receiver_min = glm::vec3(FLT_MAX);
+        glm::vec3 receiver_max = glm::vec3(-FLT_MAX);
+        uint32_t  receivers    = 0;
+
+        for (uint32_t j = 0; j < entity_count; j++)
+        {
+            Entity& e = entities[j];
+
+            if (!e.visibility(camera_view_index) || !intersects(slice_frustum, e.obb))
+                continue;
+
+            glm::vec3 entity_corners[8];
+            obb_corners(e.obb, entity_corners);
+
+            for (int k = 0; k < 8; k++)
+            {
+                glm::vec3 p  = glm::vec3(light_view * glm::vec4(entity_corners[k], 1.0f));
+                receiver_min = glm::min(receiver_min, p);
+                receiver_max = glm::max(receiver_max, p);
+            }
+
+            receivers++;
+        }
+
+        float left   = -radius;
+        float right  = radius;
+        float bottom = -radius;
+        float top    = radius;
+        float z_near = -(radius + csm.near_offset);
+        float z_far  = radius;
+
+        if (receivers > 0)
+        {
+            // Shrink in coarse steps so the window (and therefore the texel size) stays put while the receiver set is stable.
+            float step = (2.0f * radius) / float(CSM_TIGHTEN_STEPS);
+
+            left   = std::max(left, floorf(receiver_min.x / step) * step);
+            right  = std::min(right, ceilf(receiver_max.x / step) * step);
+            bottom = std::max(bottom, floorf(receiver_min.y / step) * step);
+            top    = std::min(top, ceilf(receiver_max.y / step) * step);
+
+            // The light looks down -Z, so the farthest receiver has the smallest Z.
+            z_far = std::min(z_far, ceilf(-receiver_min.z / step) * step);
+
+            if (right <= left || top <= bottom || z_far <= z_near)
+            {
+                left   = -radius;
+                right  = radius;
+                bottom = -radius;
+                top    = radius;
+                z_far  = radius;
+            }
+        }
+
+        glm::mat4 light_projection = glm::ortho(left, right, bottom, top, z_near, z_far);
+
+        // Snap the projection to whole shadow map texels so edges don't shimmer as the camera moves.
+        float     half_size     = float(csm.shadow_map_size) * 0.5f;
+        glm::mat4 shadow_matrix = light_projection * light_view;
+        glm::vec4 origin        = shadow_matrix * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+        origin *= half_size;
+
+        glm::vec4 offset = (glm::round(origin) - origin) / half_size;
+
+        light_projection[3][0] += offset.x;
+        light_projection[3][1] += offset.y;
+
+        csm.view[i]            = light_view;
+        csm.projection[i]      = light_projection;
+        csm.view_projection[i] = light_projection * light_view;
+        csm.texel_size[i]      = (right - left) / float(csm.shadow_map_size);
+        csm.receiver_count[i]  = receivers;
+
+        frustum_from_matrix(csm.frustum[i], csm.view_projection[i]);
+
+        // Cull casters into this cascade's visibility bit.
+        uint32_t view_index = csm.view_index_base + i;
+        uint32_t casters    = 0;
+
+        for (uint32_t j = 0; j < entity_count; j++)
+        {
+            Entity& e = entities[j];
+
+            if (receivers > 0 && intersects_caster_volume(csm.frustum[i], e.obb))
+            {
+                e.set_visible(view_index);
+                casters++;
+            }
+            else
+                e.set_invisible(view_index);
+        }
+
+        csm.caster_count[i] = casters;
+    }
+
+    // Only clear the bits of cascades that were active in the previous update. Bits past those may belong to other views.
+    for (uint32_t i = cascade_count; i < MAX_SHADOW_MAP_CASCADES; i++)
+    {
+        csm.receiver_count[i] = 0;
+        csm.caster_count[i]   = 0;
+
+        if (i >= csm.active_cascade_count)
+            continue;
+
+        for (uint32_t j = 0; j < entity_count; j++)
+            entities[j].set_invisible(csm.view_index_base + i);
+    }
+
+    csm.active_cascade_count = cascade_count;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
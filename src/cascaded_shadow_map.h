@@ -0,0 +1,44 @@
+#pragma once
+
+#include "geometry.h"
+#include "constants.h"
+#include <stdint.h>
+
+namespace inferno
+{
+struct Camera;
+struct Entity;
+
+struct CascadedShadowMap
+{
+    // Settings. Change these before calling update_cascades().
+    uint32_t cascade_count   = 4;
+    uint32_t shadow_map_size = 2048;
+    // Blend between uniform (0.0) and logarithmic (1.0) split distribution.
+    float lambda = 0.5f;
+    // Extra distance the light near plane is pulled back by to catch casters outside the view.
+    float near_offset = 250.0f;
+    // Bit index of the first cascade in Entity::visibility_flags. Cascade i uses bit (view_index_base + i), so only the bits of
+    // active cascades are touched.
+    uint32_t view_index_base = 1;
+
+    // Outputs.
+    float     split_distances[MAX_SHADOW_MAP_CASCADES + 1];
+    float     texel_size[MAX_SHADOW_MAP_CASCADES];
+    glm::mat4 view[MAX_SHADOW_MAP_CASCADES];
+    glm::mat4 projection[MAX_SHADOW_MAP_CASCADES];
+    glm::mat4 view_projection[MAX_SHADOW_MAP_CASCADES];
+    Frustum   frustum[MAX_SHADOW_MAP_CASCADES];
+    uint32_t  receiver_count[MAX_SHADOW_MAP_CASCADES];
+    uint32_t  caster_count[MAX_SHADOW_MAP_CASCADES];
+    // Number of cascades built by the last update. Used to clear the bits of cascades that have since been disabled.
+    uint32_t active_cascade_count = 0;
+};
+
+// Computes practical split distances (Zhang et al.) between the camera near and far planes. 'splits' must hold cascade_count + 1 values.
+extern void compute_cascade_splits(const Camera& camera, uint32_t cascade_count, float lambda, float* splits);
+
+// Builds texel-snapped orthographic projections for every cascade, tightens them to the receivers visible in 'camera_view_index'
+// and writes per-cascade caster visibility into the Entity visibility flags.
+extern void update_cascades(CascadedShadowMap& csm, const Camera& camera, const glm::vec3& light_direction, Entity* entities, uint32_t entity_count, uint32_t camera_view_index);
+} // namespace inferno
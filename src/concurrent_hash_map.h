@@ -0,0 +1,308 @@
+#pragma once
+
+#include "murmur_hash.h"
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Shards are picked from the top bits of the hash, buckets from the bottom bits.
+#define CONCURRENT_HASH_MAP_SHARD_BITS 4
+#define CONCURRENT_HASH_MAP_SHARD_COUNT (1 << CONCURRENT_HASH_MAP_SHARD_BITS)
+// A shard doubles its bucket count once it holds this many entries per bucket.
+#define CONCURRENT_HASH_MAP_MAX_LOAD 2
+
+namespace inferno
+{
+// Insert-only map for caches that are filled once and then read from many threads, e.g. pipelines or samplers keyed by their
+// description. Reads are lock-free: they walk immutable nodes published with release stores. Inserts take the lock of one of
+// CONCURRENT_HASH_MAP_SHARD_COUNT shards. Growing a shard builds a new bucket array with copies of its nodes and keeps the old
+// ones alive, so readers still walking them stay valid. Everything is freed in clear() or the destructor, which must not run
+// concurrently with anything else. KEY needs operator==, VALUE should be cheap to copy (e.g. a shared_ptr).
+template <typename KEY, typename VALUE>
+class ConcurrentHashMap
+{
+public:
+    struct Node
+    {
+        uint64_t hash;
+        KEY      key;
+        VALUE    value;
+        Node*    next;
+    };
+
+    struct Table
+    {
+        uint32_t                             mask;
+        std::unique_ptr<std::atomic<Node*>[]> buckets;
+    };
+
+    struct Shard
+    {
+        std::atomic<Table*>                 table;
+        std::mutex                          mutex;
+        std::condition_variable             pending_done;
+        std::vector<uint64_t>               pending; // Hashes of the keys currently being created by get_or_create().
+        std::vector<std::unique_ptr<Table>> tables;  // Current and retired tables.
+        std::vector<std::unique_ptr<Node>>  nodes;   // Every node ever allocated, including copies in retired tables.
+        uint32_t                            count = 0;
+    };
+
+    Shard    m_shards[CONCURRENT_HASH_MAP_SHARD_COUNT];
+    uint32_t m_initial_buckets;
+
+public:
+    // 'initial_buckets' is per shard and rounded up to a power of two.
+    ConcurrentHashMap(uint32_t initial_buckets = 64)
+    {
+        m_initial_buckets = 1;
+
+        while (m_initial_buckets < initial_buckets)
+            m_initial_buckets *= 2;
+
+        for (auto& shard : m_shards)
+            reset(shard);
+    }
+
+    ~ConcurrentHashMap()
+    {
+    }
+
+    // Lock-free.
+    bool get(const KEY& key, VALUE& value)
+    {
+        uint64_t    hash = create_hash(key);
+        const Node* node = find(shard_for(hash), key, hash);
+
+        if (!node)
+            return false;
+
+        value = node->value;
+        return true;
+    }
+
+    // Lock-free.
+    bool has(const KEY& key)
+    {
+        uint64_t hash = create_hash(key);
+        return find(shard_for(hash), key, hash) != nullptr;
+    }
+
+    // Returns false and leaves the map unchanged if the key is already present.
+    bool insert(const KEY& key, const VALUE& value)
+    {
+        uint64_t hash  = create_hash(key);
+        Shard&   shard = shard_for(hash);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (find(shard, key, hash))
+            return false;
+
+        publish(shard, key, hash, value);
+        return true;
+    }
+
+    // Returns the value for 'key', calling 'create' to build it if it is missing. Only one thread builds a given key; the others
+    // block until it is done and then return the same value. If 'create' throws, the key stays missing and the exception
+    // propagates to the thread that called it, while the waiting threads retry.
+    template <typename CREATE>
+    VALUE get_or_create(const KEY& key, CREATE create)
+    {
+        VALUE value;
+        get_or_create(key, create, true, value);
+        return value;
+    }
+
+    // Same as get_or_create() but returns false instead of waiting if another thread is already building 'key', e.g. so a
+    // recording thread can skip a draw whose pipeline isn't ready yet.
+    template <typename CREATE>
+    bool try_get_or_create(const KEY& key, CREATE create, VALUE& value)
+    {
+        return get_or_create(key, create, false, value);
+    }
+
+    void clear()
+    {
+        for (auto& shard : m_shards)
+            reset(shard);
+    }
+
+    uint32_t size()
+    {
+        uint32_t count = 0;
+
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.count;
+        }
+
+        return count;
+    }
+
+private:
+    inline Shard& shard_for(uint64_t hash)
+    {
+        return m_shards[hash >> (64 - CONCURRENT_HASH_MAP_SHARD_BITS)];
+    }
+
+    void reset(Shard& shard)
+    {
+        shard.tables.clear();
+        shard.nodes.clear();
+        shard.pending.clear();
+        shard.count = 0;
+        shard.table.store(allocate(shard, m_initial_buckets), std::memory_order_release);
+    }
+
+    static Table* allocate(Shard& shard, uint32_t bucket_count)
+    {
+        std::unique_ptr<Table> table(new Table());
+
+        table->mask    = bucket_count - 1;
+        table->buckets = std::unique_ptr<std::atomic<Node*>[]>(new std::atomic<Node*>[bucket_count]);
+
+        for (uint32_t i = 0; i < bucket_count; i++)
+            table->buckets[i].store(nullptr, std::memory_order_relaxed);
+
+        shard.tables.push_back(std::move(table));
+
+        return shard.tables.back().get();
+    }
+
+    static const Node* find(Shard& shard, const KEY& key, uint64_t hash)
+    {
+        Table*      table = shard.table.load(std::memory_order_acquire);
+        const Node* node  = table->buckets[hash & table->mask].load(std::memory_order_acquire);
+
+        while (node)
+        {
+            if (node->hash == hash && node->key == key)
+                return node;
+
+            node = node->next;
+        }
+
+        return nullptr;
+    }
+
+    // Must be called with the shard locked. Nodes are fully built before being linked in, so readers never see a partial one.
+    void publish(Shard& shard, const KEY& key, uint64_t hash, const VALUE& value)
+    {
+        Table* table = shard.table.load(std::memory_order_relaxed);
+
+        if (shard.count + 1 > (table->mask + 1) * CONCURRENT_HASH_MAP_MAX_LOAD)
+            table = grow(shard, table);
+
+        std::atomic<Node*>& head = table->buckets[hash & table->mask];
+
+        shard.nodes.push_back(std::unique_ptr<Node>(new Node { hash, key, value, head.load(std::memory_order_relaxed) }));
+        head.store(shard.nodes.back().get(), std::memory_order_release);
+        shard.count++;
+    }
+
+    // Must be called with the shard locked.
+    Table* grow(Shard& shard, Table* old_table)
+    {
+        Table* table = allocate(shard, (old_table->mask + 1) * 2);
+
+        for (uint32_t i = 0; i <= old_table->mask; i++)
+        {
+            for (Node* node = old_table->buckets[i].load(std::memory_order_relaxed); node; node = node->next)
+            {
+                std::atomic<Node*>& head = table->buckets[node->hash & table->mask];
+
+                shard.nodes.push_back(std::unique_ptr<Node>(new Node { node->hash, node->key, node->value, head.load(std::memory_order_relaxed) }));
+                head.store(shard.nodes.back().get(), std::memory_order_relaxed);
+            }
+        }
+
+        shard.table.store(table, std::memory_order_release);
+
+        return table;
+    }
+
+    template <typename CREATE>
+    bool get_or_create(const KEY& key, CREATE& create, bool wait, VALUE& value)
+    {
+        uint64_t hash  = create_hash(key);
+        Shard&   shard = shard_for(hash);
+
+        if (const Node* node = find(shard, key, hash))
+        {
+            value = node->value;
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        while (true)
+        {
+            if (const Node* node = find(shard, key, hash))
+            {
+                value = node->value;
+                return true;
+            }
+
+            // Pending keys are tracked by hash only, so a colliding key may wait a little longer than it has to. Harmless.
+            bool pending = false;
+
+            for (uint64_t h : shard.pending)
+                pending |= h == hash;
+
+            if (!pending)
+                break;
+
+            if (!wait)
+                return false;
+
+            shard.pending_done.wait(lock);
+        }
+
+        shard.pending.push_back(hash);
+        lock.unlock();
+
+        try
+        {
+            value = create();
+        }
+        catch (...)
+        {
+            lock.lock();
+            finish_pending(shard, hash);
+            throw;
+        }
+
+        lock.lock();
+
+        // A plain insert() may have raced in while the lock was released. Keep the value that is already visible.
+        if (const Node* node = find(shard, key, hash))
+            value = node->value;
+        else
+            publish(shard, key, hash, value);
+
+        finish_pending(shard, hash);
+
+        return true;
+    }
+
+    // Must be called with the shard locked.
+    static void finish_pending(Shard& shard, uint64_t hash)
+    {
+        for (size_t i = 0; i < shard.pending.size(); i++)
+        {
+            if (shard.pending[i] == hash)
+            {
+                shard.pending[i] = shard.pending.back();
+                shard.pending.pop_back();
+                break;
+            }
+        }
+
+        shard.pending_done.notify_all();
+    }
+};
+} // namespace inferno
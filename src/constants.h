@@ -11,4 +11,5 @@
 #define MAX_SHADOW_CASTING_POINT_LIGHTS 8
 #define MAX_SHADOW_CASTING_SPOT_LIGHTS 8
 #define MAX_SHADOW_CASTING_DIRECTIONAL_LIGHTS 8
-#define MAX_BONES 100
\ No newline at end of file
+#define MAX_BONES 100
+#define MAX_LOD_LEVELS 8
\ No newline at end of file
@@ -1,9 +1,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 #include <assert.h>
 
-namespace nimble
+namespace inferno
 {
 template <typename T, size_t N>
 class Deque
@@ -78,4 +79,4 @@ public:
         return _data[++_front];
     }
 };
-} // namespace nimble
\ No newline at end of file
+} // namespace inferno
\ No newline at end of file
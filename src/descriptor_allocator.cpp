@@ -0,0 +1,186 @@
+#include "descriptor_allocator.h"
+#include "logger.h"
+#include "macros.h"
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DescriptorAllocator::Ptr DescriptorAllocator::create(Backend::Ptr backend, const DescriptorPool::Desc& pool_desc)
+{
+    return std::shared_ptr<DescriptorAllocator>(new DescriptorAllocator(backend, pool_desc));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DescriptorAllocator::DescriptorAllocator(Backend::Ptr backend, const DescriptorPool::Desc& pool_desc) :
+    Object(backend), m_pool_desc(pool_desc)
+{
+    m_frames_in_flight = backend->frames_in_flight();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+
+    for (auto& frame : m_frames)
+    {
+        for (auto pool : frame.pools)
+            vkDestroyDescriptorPool(m_vk_device, pool, nullptr);
+    }
+
+    for (auto pool : m_persistent.pools)
+        vkDestroyDescriptorPool(m_vk_device, pool, nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DescriptorAllocator::begin_frame(const FrameContext& frame)
+{
+    m_frame_index = uint32_t(frame.frame_number % m_frames_in_flight);
+
+    // The frame's fence has been waited on, so none of the sets allocated the last time this context was used are in flight.
+    reset(m_frames[m_frame_index]);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkDescriptorSet DescriptorAllocator::allocate_transient(VkDescriptorSetLayout layout)
+{
+    return allocate(m_frames[m_frame_index], layout);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkDescriptorSet DescriptorAllocator::allocate_persistent(VkDescriptorSetLayout layout)
+{
+    return allocate(m_persistent, layout);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DescriptorAllocator::reset_persistent()
+{
+    reset(m_persistent);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DescriptorAllocatorStats DescriptorAllocator::stats()
+{
+    DescriptorAllocatorStats stats;
+    INFERNO_ZERO_MEMORY(stats);
+
+    const PoolChain& frame = m_frames[m_frame_index];
+
+    for (uint32_t i = 0; i < m_frames_in_flight; i++)
+        stats.transient_pools += uint32_t(m_frames[i].pools.size());
+
+    stats.transient_sets   = frame.sets;
+    stats.persistent_pools = uint32_t(m_persistent.pools.size());
+    stats.persistent_sets  = m_persistent.sets;
+
+    if (!frame.pools.empty())
+        stats.transient_utilization = float(frame.sets) / float(frame.pools.size() * m_pool_desc.max_sets);
+
+    if (!m_persistent.pools.empty())
+        stats.persistent_utilization = float(m_persistent.sets) / float(m_persistent.pools.size() * m_pool_desc.max_sets);
+
+    return stats;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkDescriptorSet DescriptorAllocator::allocate(PoolChain& chain, VkDescriptorSetLayout layout)
+{
+    VkDescriptorSetAllocateInfo info;
+    INFERNO_ZERO_MEMORY(info);
+
+    info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    info.descriptorSetCount = 1;
+    info.pSetLayouts        = &layout;
+
+    // Tries the current pool first, then moves down the chain and finally creates a new pool. Pools that ran out are not revisited
+    // until the chain is reset.
+    while (true)
+    {
+        bool fresh = chain.current == chain.pools.size();
+
+        if (fresh)
+            chain.pools.push_back(create_pool());
+
+        info.descriptorPool = chain.pools[chain.current];
+
+        VkDescriptorSet set    = nullptr;
+        VkResult        result = vkAllocateDescriptorSets(m_vk_device, &info, &set);
+
+        if (result == VK_SUCCESS)
+        {
+            chain.sets++;
+            return set;
+        }
+
+        if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to allocate descriptor set.");
+            throw std::runtime_error("(Vulkan) Failed to allocate descriptor set.");
+        }
+
+        // A set that doesn't even fit into an empty pool never will.
+        if (fresh)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Descriptor set does not fit into the pool size of the Descriptor Allocator.");
+            throw std::runtime_error("(Vulkan) Descriptor set does not fit into the pool size of the Descriptor Allocator.");
+        }
+
+        chain.current++;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkDescriptorPool DescriptorAllocator::create_pool()
+{
+    VkDescriptorPoolCreateInfo pool_info;
+    INFERNO_ZERO_MEMORY(pool_info);
+
+    pool_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags         = m_pool_desc.flags & ~VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    pool_info.poolSizeCount = static_cast<uint32_t>(m_pool_desc.pool_sizes.size());
+    pool_info.pPoolSizes    = m_pool_desc.pool_sizes.data();
+    pool_info.maxSets       = m_pool_desc.max_sets;
+
+    VkDescriptorPool pool;
+
+    if (vkCreateDescriptorPool(m_vk_device, &pool_info, nullptr, &pool) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to create descriptor pool.");
+        throw std::runtime_error("(Vulkan) Failed to create descriptor pool.");
+    }
+
+    return pool;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DescriptorAllocator::reset(PoolChain& chain)
+{
+    // Only the pools that were actually used need resetting.
+    for (uint32_t i = 0; i < chain.pools.size() && i <= chain.current; i++)
+        vkResetDescriptorPool(m_vk_device, chain.pools[i], 0);
+
+    chain.current = 0;
+    chain.sets    = 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vk.h"
+#include <stdint.h>
+#include <vector>
+
+namespace inferno
+{
+namespace vk
+{
+struct DescriptorAllocatorStats
+{
+    uint32_t transient_pools;
+    // Sets allocated in the current frame, and their share of the set capacity of the frame's pools.
+    uint32_t transient_sets;
+    float    transient_utilization;
+    uint32_t persistent_pools;
+    uint32_t persistent_sets;
+    float    persistent_utilization;
+};
+
+// Allocates descriptor sets from chains of pools that grow on exhaustion instead of failing. Sets are never freed individually,
+// so the pools don't need VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT and never fragment.
+//
+// Transient sets come from pools owned by the current frame in flight. They are valid until the same frame context comes around
+// again, at which point begin_frame() resets all of that frame's pools with vkResetDescriptorPool. Persistent sets come from a
+// separate chain of pools and live until reset_persistent() or the allocator is destroyed.
+//
+// Every pool is created from the same Desc: 'max_sets' sets and the given descriptor counts. Not thread-safe.
+class DescriptorAllocator : public Object
+{
+public:
+    using Ptr = std::shared_ptr<DescriptorAllocator>;
+
+    static DescriptorAllocator::Ptr create(Backend::Ptr backend, const DescriptorPool::Desc& pool_desc);
+
+    ~DescriptorAllocator();
+
+    // Call once per frame after Backend::begin_frame().
+    void begin_frame(const FrameContext& frame);
+
+    VkDescriptorSet allocate_transient(VkDescriptorSetLayout layout);
+    VkDescriptorSet allocate_persistent(VkDescriptorSetLayout layout);
+
+    // Releases every persistent set at once. The caller must make sure none of them is still in use by the GPU.
+    void reset_persistent();
+
+    DescriptorAllocatorStats stats();
+
+private:
+    struct PoolChain
+    {
+        std::vector<VkDescriptorPool> pools;
+        uint32_t                      current = 0;
+        uint32_t                      sets    = 0;
+    };
+
+    DescriptorAllocator(Backend::Ptr backend, const DescriptorPool::Desc& pool_desc);
+    VkDescriptorSet  allocate(PoolChain& chain, VkDescriptorSetLayout layout);
+    VkDescriptorPool create_pool();
+    void             reset(PoolChain& chain);
+
+private:
+    DescriptorPool::Desc m_pool_desc;
+    PoolChain            m_frames[MAX_FRAMES_IN_FLIGHT];
+    PoolChain            m_persistent;
+    uint32_t             m_frames_in_flight;
+    uint32_t             m_frame_index = 0;
+};
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "entity.h"
+#include "constants.h"
+
+namespace inferno
+{
+struct DrawItem
+{
+    uint32_t entity_index;
+    uint32_t lod;
+};
+
+struct DrawList
+{
+    uint32_t count = 0;
+    DrawItem items[MAX_ENTITIES];
+};
+
+// Gathers the entities visible in 'view_index' along with their selected LOD. Run after culling and select_lods().
+inline void build_draw_list(DrawList& list, Entity* entities, uint32_t entity_count, uint32_t view_index)
+{
+    list.count = 0;
+
+    for (uint32_t i = 0; i < entity_count; i++)
+    {
+        Entity& e = entities[i];
+
+        if (!e.visibility(view_index))
+            continue;
+
+        DrawItem& item    = list.items[list.count++];
+        item.entity_index = i;
+        item.lod          = e.lod.selected_level(view_index);
+    }
+}
+} // namespace inferno
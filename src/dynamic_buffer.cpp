@@ -0,0 +1,126 @@
+#include "dynamic_buffer.h"
+#include "logger.h"
+#include "macros.h"
+#include <vk_mem_alloc.h>
+#include <algorithm>
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DynamicRingBuffer::Ptr DynamicRingBuffer::create(Backend::Ptr backend, VkBufferUsageFlags usage, size_t frame_size, size_t max_range)
+{
+    return std::shared_ptr<DynamicRingBuffer>(new DynamicRingBuffer(backend, usage, frame_size, max_range));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DynamicRingBuffer::DynamicRingBuffer(Backend::Ptr backend, VkBufferUsageFlags usage, size_t frame_size, size_t max_range) :
+    Object(backend)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(backend->physical_device(), &properties);
+
+    m_alignment = 1;
+
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+        m_alignment = std::max(m_alignment, size_t(properties.limits.minUniformBufferOffsetAlignment));
+
+    if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+        m_alignment = std::max(m_alignment, size_t(properties.limits.minStorageBufferOffsetAlignment));
+
+    // The descriptor range is 'max_range', which has to be within the limit of every descriptor type the buffer can be bound as.
+    if (((usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) && max_range > size_t(properties.limits.maxUniformBufferRange)) || ((usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) && max_range > size_t(properties.limits.maxStorageBufferRange)))
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Dynamic Ring Buffer range exceeds the device limit.");
+        throw std::runtime_error("(Vulkan) Dynamic Ring Buffer range exceeds the device limit.");
+    }
+
+    m_frames_in_flight = backend->frames_in_flight();
+    m_frame_size       = (frame_size + m_alignment - 1) & ~(m_alignment - 1);
+    m_max_range        = max_range;
+
+    // The descriptor always covers 'max_range' bytes from the dynamic offset, so the last allocation needs that much room behind
+    // it even if it is smaller.
+    size_t size = m_frame_size * m_frames_in_flight + m_max_range;
+
+    // Dynamic offsets are 32 bit.
+    if (size > size_t(UINT32_MAX))
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Dynamic Ring Buffer larger than 4 GiB.");
+        throw std::runtime_error("(Vulkan) Dynamic Ring Buffer larger than 4 GiB.");
+    }
+
+    m_buffer     = Buffer::create(backend, usage, size, VMA_MEMORY_USAGE_CPU_TO_GPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    m_mapped_ptr = static_cast<uint8_t*>(m_buffer->mapped_ptr());
+    m_head       = m_frame_begin;
+
+    // Writes are never flushed, so they are only visible to the GPU if the memory is host coherent. Buffer requires coherent
+    // memory for CPU_TO_GPU, this makes sure that never changes silently.
+    if (!(m_buffer->memory_properties() & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Dynamic Ring Buffer memory is not host coherent.");
+        throw std::runtime_error("(Vulkan) Dynamic Ring Buffer memory is not host coherent.");
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DynamicRingBuffer::~DynamicRingBuffer()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DynamicRingBuffer::begin_frame(const FrameContext& frame)
+{
+    m_frame_begin = (frame.frame_number % m_frames_in_flight) * m_frame_size;
+    m_head        = m_frame_begin;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DynamicAllocation DynamicRingBuffer::allocate(size_t size)
+{
+    size_t offset = m_head;
+    size_t end    = offset + ((size + m_alignment - 1) & ~(m_alignment - 1));
+
+    if (size > m_max_range || end > m_frame_begin + m_frame_size)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Dynamic Ring Buffer out of space for this frame.");
+        throw std::runtime_error("(Vulkan) Dynamic Ring Buffer out of space for this frame.");
+    }
+
+    m_head = end;
+
+    DynamicAllocation alloc;
+
+    alloc.ptr    = m_mapped_ptr + offset;
+    alloc.offset = uint32_t(offset);
+
+    return alloc;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkDescriptorBufferInfo DynamicRingBuffer::descriptor_info()
+{
+    VkDescriptorBufferInfo info;
+
+    info.buffer = m_buffer->handle();
+    info.offset = 0;
+    info.range  = m_max_range;
+
+    return info;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
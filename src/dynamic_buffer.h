@@ -0,0 +1,68 @@
+#pragma once
+
+#include "vk.h"
+#include <stdint.h>
+#include <string.h>
+
+namespace inferno
+{
+namespace vk
+{
+// A sub-range of a DynamicRingBuffer. 'offset' is passed as the dynamic offset when binding the descriptor set.
+struct DynamicAllocation
+{
+    void*    ptr;
+    uint32_t offset;
+};
+
+// Hands out aligned sub-ranges of one persistently mapped, host coherent buffer for per-draw and per-view constants. Every frame
+// in flight owns a region of 'frame_size' bytes which is rewound by begin_frame(), so writing a constant block is a pointer bump
+// and a memcpy without any Vulkan calls.
+//
+// Bind the buffer once as VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC (or STORAGE_BUFFER_DYNAMIC) using descriptor_info(), then pass
+// DynamicAllocation::offset to vkCmdBindDescriptorSets. No single allocation may be larger than 'max_range'. Not thread-safe.
+class DynamicRingBuffer : public Object
+{
+public:
+    using Ptr = std::shared_ptr<DynamicRingBuffer>;
+
+    static DynamicRingBuffer::Ptr create(Backend::Ptr backend, VkBufferUsageFlags usage, size_t frame_size, size_t max_range);
+
+    ~DynamicRingBuffer();
+
+    // Rewinds to the region of 'frame'. Must be called after Backend::begin_frame(), which guarantees the GPU is done with it.
+    void begin_frame(const FrameContext& frame);
+
+    DynamicAllocation allocate(size_t size);
+
+    template <typename T>
+    inline uint32_t push(const T& data)
+    {
+        DynamicAllocation alloc = allocate(sizeof(T));
+        memcpy(alloc.ptr, &data, sizeof(T));
+
+        return alloc.offset;
+    }
+
+    VkDescriptorBufferInfo descriptor_info();
+
+    inline VkBuffer handle() { return m_buffer->handle(); }
+    inline size_t   alignment() { return m_alignment; }
+    inline size_t   frame_size() { return m_frame_size; }
+    inline size_t   used() { return m_head - m_frame_begin; }
+
+private:
+    DynamicRingBuffer(Backend::Ptr backend, VkBufferUsageFlags usage, size_t frame_size, size_t max_range);
+
+private:
+    Buffer::Ptr m_buffer;
+    uint8_t*    m_mapped_ptr;
+    uint32_t    m_frames_in_flight;
+    size_t      m_alignment;
+    size_t      m_frame_size;
+    size_t      m_max_range;
+    size_t      m_frame_begin = 0;
+    size_t      m_head        = 0;
+};
+} // namespace vk
+} // namespace inferno
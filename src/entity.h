@@ -3,6 +3,7 @@
 #include "geometry.h"
 #include "transform.h"
 #include "macros.h"
+#include "constants.h"
 #include <string>
 #include <vector>
 
@@ -10,6 +11,19 @@
 
 namespace inferno
 {
+struct LODChain
+{
+    // Minimum projected bounding sphere diameter (in pixels) for each level, in decreasing order. Level 0 is the most detailed.
+    float    screen_sizes[MAX_LOD_LEVELS];
+    uint32_t level_count = 1;
+    // Hysteresis state is kept per view so selecting for a shadow or reflection view doesn't disturb the camera's choice.
+    uint8_t  selected[MAX_VIEWS] = {};
+    uint64_t culled              = 0;
+
+    inline uint32_t selected_level(const uint32_t& view_index) const { return selected[view_index]; }
+    inline bool     is_culled(const uint32_t& view_index) const { return (culled & BIT_FLAG_64(view_index)) != 0; }
+};
+
 struct Entity
 {
     using ID = uint32_t;
@@ -21,6 +35,7 @@ struct Entity
     bool        dirty;
     bool        is_static;
     Transform   transform;
+    LODChain    lod;
 
 #ifdef ENABLE_SUBMESH_CULLING
     std::vector<Sphere>   submesh_spheres;
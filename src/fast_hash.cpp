@@ -0,0 +1,229 @@
+#include "fast_hash.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define FAST_HASH_SSE
+#endif
+
+#define FAST_HASH_STRIPE_SIZE 64
+#define FAST_HASH_STRIPES_PER_BLOCK 16
+#define FAST_HASH_BLOCK_SIZE (FAST_HASH_STRIPE_SIZE * FAST_HASH_STRIPES_PER_BLOCK)
+// Each stripe of a block reads the secret 8 bytes further along.
+#define FAST_HASH_SECRET_SIZE 192
+#define FAST_HASH_SCRAMBLE_OFFSET (FAST_HASH_SECRET_SIZE - FAST_HASH_STRIPE_SIZE)
+#define FAST_HASH_LAST_STRIPE_OFFSET (FAST_HASH_SECRET_SIZE - FAST_HASH_STRIPE_SIZE - 7)
+
+#define FAST_HASH_PRIME32_1 0x9e3779b1u
+#define FAST_HASH_PRIME64_1 0x9e3779b185ebca87ull
+
+namespace inferno
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static const uint64_t g_secret[FAST_HASH_SECRET_SIZE / 8] = {
+    0x3a34ce6380fc0bc5ull, 0xc05a677850dc981aull, 0x9e32cdf7948370bdull, 0xa7765f796f00bbefull,
+    0xbbbb23fe6921fe52ull, 0x5bf0c31cacf1e17full, 0x3e1900a6529be043ull, 0x2a16cd9ed424ea1eull,
+    0x579593114410e048ull, 0x0a29f5fe3df351f0ull, 0x1b4897e079059ad2ull, 0x2d9cd179c9e412e1ull,
+    0x315949173d12f7e0ull, 0x7c69b356b72b606full, 0xb6ec11f8caa9ebcfull, 0x841e03b1ed92f734ull,
+    0x8898a5df2ba2ae99ull, 0xf810fea09e7eeaa5ull, 0x27a56de32b6a852cull, 0x141d3cdeb2a328a7ull,
+    0xfa6c784c6c59c00full, 0x6bb8c0b28140b75full, 0xb3469baeabcf5facull, 0xc03b1af969a981b8ull
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+#if defined(FAST_HASH_SSE)
+
+struct Accumulator
+{
+    __m128i lanes[4];
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void accumulate(Accumulator& acc, const uint8_t* p, const uint8_t* secret)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i data     = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i);
+        __m128i key      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+        __m128i data_key = _mm_xor_si128(data, key);
+
+        // Multiply the low and high 32 bits of each 64-bit lane and add the neighbouring lane's input on top.
+        __m128i product = _mm_mul_epu32(data_key, _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+        acc.lanes[i] = _mm_add_epi64(acc.lanes[i], _mm_add_epi64(product, swapped));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void scramble(Accumulator& acc, const uint8_t* secret)
+{
+    const __m128i prime = _mm_set1_epi32(int(FAST_HASH_PRIME32_1));
+
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i a   = acc.lanes[i];
+        __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+
+        a = _mm_xor_si128(_mm_xor_si128(a, _mm_srli_epi64(a, 47)), key);
+
+        // 64-bit multiply by a 32-bit constant out of two 32x32 -> 64 products.
+        __m128i lo = _mm_mul_epu32(a, prime);
+        __m128i hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+
+        acc.lanes[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void store(const Accumulator& acc, uint64_t* out)
+{
+    for (int i = 0; i < 4; i++)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out) + i, acc.lanes[i]);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void load(Accumulator& acc, const uint64_t* in)
+{
+    for (int i = 0; i < 4; i++)
+        acc.lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in) + i);
+}
+
+#else
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct Accumulator
+{
+    uint64_t lanes[8];
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void accumulate(Accumulator& acc, const uint8_t* p, const uint8_t* secret)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t data     = fast_hash_read64(p + i * 8);
+        uint64_t data_key = data ^ fast_hash_read64(secret + i * 8);
+
+        acc.lanes[i ^ 1] += data;
+        acc.lanes[i] += (data_key & 0xffffffff) * (data_key >> 32);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void scramble(Accumulator& acc, const uint8_t* secret)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t a = acc.lanes[i];
+
+        a ^= a >> 47;
+        a ^= fast_hash_read64(secret + i * 8);
+        a *= FAST_HASH_PRIME32_1;
+
+        acc.lanes[i] = a;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void store(const Accumulator& acc, uint64_t* out)
+{
+    memcpy(out, &acc.lanes[0], sizeof(acc.lanes));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void load(Accumulator& acc, const uint64_t* in)
+{
+    memcpy(&acc.lanes[0], in, sizeof(acc.lanes));
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t fast_hash_long(const uint8_t* p, size_t len, uint64_t seed)
+{
+    const uint8_t* secret = reinterpret_cast<const uint8_t*>(&g_secret[0]);
+    uint64_t       lanes[8];
+
+    for (int i = 0; i < 8; i++)
+        lanes[i] = g_secret[i] ^ (seed + i);
+
+    Accumulator acc;
+    load(acc, &lanes[0]);
+
+    // Always leave at least one byte for the final block so the last stripe never reads before the input.
+    size_t blocks = (len - 1) / FAST_HASH_BLOCK_SIZE;
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        const uint8_t* block = p + b * FAST_HASH_BLOCK_SIZE;
+
+        for (int s = 0; s < FAST_HASH_STRIPES_PER_BLOCK; s++)
+            accumulate(acc, block + s * FAST_HASH_STRIPE_SIZE, secret + s * 8);
+
+        scramble(acc, secret + FAST_HASH_SCRAMBLE_OFFSET);
+    }
+
+    const uint8_t* tail    = p + blocks * FAST_HASH_BLOCK_SIZE;
+    size_t         stripes = (len - blocks * FAST_HASH_BLOCK_SIZE - 1) / FAST_HASH_STRIPE_SIZE;
+
+    for (size_t s = 0; s < stripes; s++)
+        accumulate(acc, tail + s * FAST_HASH_STRIPE_SIZE, secret + s * 8);
+
+    // The last stripe is taken from the end of the input and may overlap the previous one.
+    accumulate(acc, p + len - FAST_HASH_STRIPE_SIZE, secret + FAST_HASH_LAST_STRIPE_OFFSET);
+
+    store(acc, &lanes[0]);
+
+    uint64_t h = len * FAST_HASH_PRIME64_1 ^ seed;
+
+    for (int i = 0; i < 4; i++)
+        h += fast_hash_mix(lanes[i * 2] ^ fast_hash_read64(secret + 11 + i * 16), lanes[i * 2 + 1] ^ fast_hash_read64(secret + 19 + i * 16));
+
+    h ^= h >> 37;
+    h *= 0x165667919e3779f9ull;
+    h ^= h >> 32;
+
+    return h;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+template <size_t KEY_SIZE>
+static void fast_hash_bulk_short(const uint8_t* p, size_t count, uint64_t seed, uint64_t* hashes)
+{
+    for (size_t i = 0; i < count; i++)
+        hashes[i] = fast_hash_short(p + i * KEY_SIZE, KEY_SIZE, seed);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void fast_hash_bulk(const void* keys, size_t key_size, size_t count, uint64_t seed, uint64_t* hashes)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(keys);
+
+    switch (key_size)
+    {
+        case 4: fast_hash_bulk_short<4>(p, count, seed, hashes); return;
+        case 8: fast_hash_bulk_short<8>(p, count, seed, hashes); return;
+        case 12: fast_hash_bulk_short<12>(p, count, seed, hashes); return;
+        case 16: fast_hash_bulk_short<16>(p, count, seed, hashes); return;
+        default: break;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        hashes[i] = fast_hash(p + i * key_size, key_size, seed);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
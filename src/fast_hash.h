@@ -0,0 +1,254 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+// Inputs longer than this take the SIMD stripe path in fast_hash_long().
+#define FAST_HASH_LONG_INPUT 256
+// FieldHasher collects fields in a buffer of this size before hashing them in one go.
+#define FIELD_HASHER_BUFFER_SIZE 128
+
+namespace inferno
+{
+// Multiply-mix constants of the short input path.
+#define FAST_HASH_SECRET_0 0xa0761d6478bd642full
+#define FAST_HASH_SECRET_1 0xe7037ed1a0b428dbull
+#define FAST_HASH_SECRET_2 0x8ebc6af09c88c6e3ull
+#define FAST_HASH_SECRET_3 0x589965cc75374cc3ull
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t fast_hash_read64(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t fast_hash_read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Full 64x64 -> 128 bit multiply. 'a' receives the low half, 'b' the high half.
+inline void fast_hash_multiply(uint64_t& a, uint64_t& b)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#elif defined(__SIZEOF_INT128__)
+    __uint128_t r = __uint128_t(a) * b;
+    a             = uint64_t(r);
+    b             = uint64_t(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = uint32_t(a), lb = uint32_t(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t  = rl + (rm0 << 32);
+    uint64_t c  = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+inline uint64_t fast_hash_mix(uint64_t a, uint64_t b)
+{
+    fast_hash_multiply(a, b);
+    return a ^ b;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Loads up to 16 bytes as two words. Shorter inputs read overlapping words instead of looping over bytes.
+inline void fast_hash_read_short(const uint8_t* p, size_t len, uint64_t& a, uint64_t& b)
+{
+    if (len >= 4)
+    {
+        size_t offset = (len >> 3) << 2;
+
+        a = (fast_hash_read32(p) << 32) | fast_hash_read32(p + offset);
+        b = (fast_hash_read32(p + len - 4) << 32) | fast_hash_read32(p + len - 4 - offset);
+    }
+    else if (len > 0)
+    {
+        a = (uint64_t(p[0]) << 16) | (uint64_t(p[len >> 1]) << 8) | p[len - 1];
+        b = 0;
+    }
+    else
+        a = b = 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Inputs of up to 16 bytes. The data goes through one 128-bit multiply that doesn't depend on the seed, so it overlaps with
+// whatever produced the seed, and the seed only enters the final mix. That leaves a single multiply between the seed and the
+// result, which matters when hashes are chained through the seed as FieldHasher does.
+inline uint64_t fast_hash_short(const uint8_t* p, size_t len, uint64_t seed)
+{
+    uint64_t a, b;
+    fast_hash_read_short(p, len, a, b);
+
+    a ^= FAST_HASH_SECRET_1;
+    b ^= FAST_HASH_SECRET_2;
+    fast_hash_multiply(a, b);
+
+    return fast_hash_mix(a ^ FAST_HASH_SECRET_0 ^ seed, b ^ FAST_HASH_SECRET_3 ^ len);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Inputs of 17 to FAST_HASH_LONG_INPUT bytes, 16 bytes per multiply. Inputs over 48 bytes split into three independent chains.
+// Like the short path the chains only depend on the data and the seed enters the final mix.
+inline uint64_t fast_hash_medium(const uint8_t* p, size_t len, uint64_t seed)
+{
+    uint64_t state = FAST_HASH_SECRET_0;
+    size_t   i     = len;
+
+    if (i > 48)
+    {
+        uint64_t state1 = state, state2 = state;
+
+        do
+        {
+            state  = fast_hash_mix(fast_hash_read64(p) ^ FAST_HASH_SECRET_1, fast_hash_read64(p + 8) ^ state);
+            state1 = fast_hash_mix(fast_hash_read64(p + 16) ^ FAST_HASH_SECRET_2, fast_hash_read64(p + 24) ^ state1);
+            state2 = fast_hash_mix(fast_hash_read64(p + 32) ^ FAST_HASH_SECRET_3, fast_hash_read64(p + 40) ^ state2);
+            p += 48;
+            i -= 48;
+        } while (i > 48);
+
+        state ^= state1 ^ state2;
+    }
+
+    while (i > 16)
+    {
+        state = fast_hash_mix(fast_hash_read64(p) ^ FAST_HASH_SECRET_1, fast_hash_read64(p + 8) ^ state);
+        i -= 16;
+        p += 16;
+    }
+
+    uint64_t a = fast_hash_read64(p + i - 16) ^ FAST_HASH_SECRET_1;
+    uint64_t b = fast_hash_read64(p + i - 8) ^ state;
+
+    fast_hash_multiply(a, b);
+
+    return fast_hash_mix(a ^ FAST_HASH_SECRET_0 ^ seed, b ^ FAST_HASH_SECRET_1 ^ len);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+extern uint64_t fast_hash_long(const uint8_t* p, size_t len, uint64_t seed);
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// General purpose 64-bit hash. Inputs up to 16 bytes take two 128-bit multiplies, inputs up to FAST_HASH_LONG_INPUT bytes
+// consume 16 bytes per multiply across three independent chains, and longer ones run through 64-byte SIMD stripes. Values are
+// the same on all platforms and instruction sets but differ from murmur_hash_64().
+//
+// Measured with InfernoBench (fast_hash) against murmur_hash_64() on x86-64: about 1.5-2x faster on 4 to 24 byte inputs chained
+// through the seed, about 2.5-3x from 32 bytes on. Hashed one at a time, independent 4 and 8 byte keys are still about 15%
+// slower than murmur, which is why create_hash() keeps using murmur for map keys; batches of them are faster through
+// fast_hash_bulk().
+inline uint64_t fast_hash(const void* key, size_t len, uint64_t seed = 0)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(key);
+
+    if (len <= 16)
+        return fast_hash_short(p, len, seed);
+
+    if (len <= FAST_HASH_LONG_INPUT)
+        return fast_hash_medium(p, len, seed);
+
+    return fast_hash_long(p, len, seed);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Hashes 'count' keys of 'key_size' bytes each, stored back to back. Gives the same values as calling fast_hash() on every key,
+// but the common key sizes of 4, 8, 12 and 16 bytes run through loops specialised for that size, so the loads are fixed and the
+// length branches of the short path disappear. The keys don't depend on each other, so the CPU keeps the multiplies of several
+// keys in flight.
+//
+// The lanes are scalar rather than SIMD on purpose: the short path is built around a full 64x64 -> 128-bit multiply, which
+// SSE2/AVX2 can only emulate with four 32-bit products plus carry handling, slower than one scalar MUL per key.
+extern void fast_hash_bulk(const void* keys, size_t key_size, size_t count, uint64_t seed, uint64_t* hashes);
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Hashes a struct one field at a time so that padding bytes never affect the result, unlike create_hash() on the whole struct.
+//
+//     FieldHasher h;
+//     h.add(desc.topology).add(desc.cull_mode).add(desc.depth_test_enable);
+//     uint64_t hash = h.result();
+class FieldHasher
+{
+public:
+    FieldHasher(uint64_t seed = 0) :
+        m_state(seed), m_size(0) {}
+
+    template <typename T>
+    FieldHasher& add(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value, "Add structs field by field so their padding isn't hashed.");
+        return add_bytes(&value, sizeof(T));
+    }
+
+    // Prefixed with the length so that consecutive strings can't run into each other.
+    FieldHasher& add(const std::string& str)
+    {
+        add(uint32_t(str.size()));
+        return add_bytes(str.data(), str.size());
+    }
+
+    FieldHasher& add_bytes(const void* data, size_t size)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+
+        while (size > 0)
+        {
+            size_t chunk = FIELD_HASHER_BUFFER_SIZE - m_size;
+
+            if (chunk > size)
+                chunk = size;
+
+            memcpy(&m_buffer[m_size], p, chunk);
+            m_size += uint32_t(chunk);
+            p += chunk;
+            size -= chunk;
+
+            if (m_size == FIELD_HASHER_BUFFER_SIZE)
+            {
+                m_state = fast_hash(&m_buffer[0], FIELD_HASHER_BUFFER_SIZE, m_state);
+                m_size  = 0;
+            }
+        }
+
+        return *this;
+    }
+
+    uint64_t result() const
+    {
+        return fast_hash(&m_buffer[0], m_size, m_state);
+    }
+
+private:
+    uint64_t m_state;
+    uint32_t m_size;
+    uint8_t  m_buffer[FIELD_HASHER_BUFFER_SIZE];
+};
+} // namespace inferno
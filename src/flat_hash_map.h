@@ -0,0 +1,541 @@
+#pragma once
+
+#include "murmur_hash.h"
+#include "macros.h"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define FLAT_HASH_MAP_SSE
+#endif
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+// Number of control bytes probed at once.
+#define FLAT_HASH_MAP_GROUP_SIZE 16
+// Number of old slots FlatHashMap moves over on each insert or remove while it is growing.
+#define FLAT_HASH_MAP_MIGRATE_SLOTS 64
+
+namespace inferno
+{
+// Control byte states. Full slots store the low 7 bits of the hash, so the sign bit alone tells free slots apart.
+#define FLAT_HASH_MAP_EMPTY int8_t(-128)
+#define FLAT_HASH_MAP_DELETED int8_t(-2)
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+inline uint32_t flat_hash_map_lowest_bit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Returns a bitmask of the slots in the group whose control byte equals 'tag'.
+inline uint32_t flat_hash_map_match(const int8_t* group, int8_t tag)
+{
+#if defined(FLAT_HASH_MAP_SSE)
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(tag))));
+#else
+    uint32_t mask = 0;
+
+    for (uint32_t i = 0; i < FLAT_HASH_MAP_GROUP_SIZE; i++)
+        mask |= uint32_t(group[i] == tag) << i;
+
+    return mask;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Returns a bitmask of the empty or deleted slots in the group.
+inline uint32_t flat_hash_map_match_free(const int8_t* group)
+{
+#if defined(FLAT_HASH_MAP_SSE)
+    return uint32_t(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    uint32_t mask = 0;
+
+    for (uint32_t i = 0; i < FLAT_HASH_MAP_GROUP_SIZE; i++)
+        mask |= uint32_t(group[i] < 0) << i;
+
+    return mask;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Open-addressing alternative to StaticHashMap. A lookup loads 16 control bytes, matches the 7-bit hash tag against all of
+// them at once and only compares the keys of matching slots, which are stored next to their values. Probing moves from group
+// to group in triangular steps and stops at the first group that has an empty slot. KEY needs operator==.
+template <typename KEY, typename VALUE, size_t SIZE>
+class StaticFlatHashMap
+{
+    static_assert(SIZE >= FLAT_HASH_MAP_GROUP_SIZE && (SIZE & (SIZE - 1)) == 0, "StaticFlatHashMap size must be a power of two of at least 16.");
+
+public:
+    struct Slot
+    {
+        KEY   key;
+        VALUE value;
+    };
+
+    INFERNO_ALIGNED(16) int8_t m_ctrl[SIZE];
+    Slot                       m_slots[SIZE];
+    uint32_t                   m_num_objects;
+    uint32_t                   m_num_deleted;
+    const uint32_t             INVALID_INDEX = 0xffffffffu;
+    const uint32_t             GROUP_COUNT   = SIZE / FLAT_HASH_MAP_GROUP_SIZE;
+
+public:
+    StaticFlatHashMap()
+    {
+        clear();
+    }
+
+    ~StaticFlatHashMap()
+    {
+    }
+
+    // Returns false if the map is full.
+    bool set(const KEY& key, const VALUE& value)
+    {
+        uint64_t hash  = create_hash(key);
+        uint32_t index = find(key, hash);
+
+        if (index == INVALID_INDEX)
+        {
+            index = find_free(hash);
+
+            if (index == INVALID_INDEX)
+                return false;
+
+            if (m_ctrl[index] == FLAT_HASH_MAP_DELETED)
+                m_num_deleted--;
+
+            m_ctrl[index]      = tag(hash);
+            m_slots[index].key = key;
+            m_num_objects++;
+        }
+
+        m_slots[index].value = value;
+
+        return true;
+    }
+
+    bool has(const KEY& key)
+    {
+        return find(key, create_hash(key)) != INVALID_INDEX;
+    }
+
+    bool get(const KEY& key, VALUE& object)
+    {
+        uint32_t index = find(key, create_hash(key));
+
+        if (index == INVALID_INDEX)
+            return false;
+        else
+        {
+            object = m_slots[index].value;
+            return true;
+        }
+    }
+
+    VALUE* get_ptr(const KEY& key)
+    {
+        uint32_t index = find(key, create_hash(key));
+
+        if (index == INVALID_INDEX)
+            return nullptr;
+        else
+            return &m_slots[index].value;
+    }
+
+    void remove(const KEY& key)
+    {
+        uint32_t index = find(key, create_hash(key));
+
+        if (index == INVALID_INDEX)
+            return;
+
+        // A probe only continues past a group with no empty slots. If this group still has one, nothing can be probing through
+        // it, so the slot can go straight back to empty instead of leaving a tombstone.
+        const int8_t* group = &m_ctrl[index & ~(FLAT_HASH_MAP_GROUP_SIZE - 1)];
+
+        if (flat_hash_map_match(group, FLAT_HASH_MAP_EMPTY))
+            m_ctrl[index] = FLAT_HASH_MAP_EMPTY;
+        else
+        {
+            m_ctrl[index] = FLAT_HASH_MAP_DELETED;
+            m_num_deleted++;
+        }
+
+        m_num_objects--;
+    }
+
+    void clear()
+    {
+        memset(&m_ctrl[0], FLAT_HASH_MAP_EMPTY, SIZE);
+        m_num_objects = 0;
+        m_num_deleted = 0;
+    }
+
+    uint32_t size()
+    {
+        return m_num_objects;
+    }
+
+private:
+    static inline int8_t tag(uint64_t hash)
+    {
+        return int8_t(hash & 0x7f);
+    }
+
+    inline uint32_t first_group(uint64_t hash)
+    {
+        return uint32_t(hash >> 7) & (GROUP_COUNT - 1);
+    }
+
+    // Returns the slot holding 'key', or INVALID_INDEX.
+    uint32_t find(const KEY& key, uint64_t hash)
+    {
+        int8_t   t     = tag(hash);
+        uint32_t group = first_group(hash);
+
+        for (uint32_t i = 0; i < GROUP_COUNT; i++)
+        {
+            const int8_t* ctrl = &m_ctrl[group * FLAT_HASH_MAP_GROUP_SIZE];
+            uint32_t      mask = flat_hash_map_match(ctrl, t);
+
+            while (mask)
+            {
+                uint32_t index = group * FLAT_HASH_MAP_GROUP_SIZE + flat_hash_map_lowest_bit(mask);
+
+                if (m_slots[index].key == key)
+                    return index;
+
+                mask &= mask - 1;
+            }
+
+            if (flat_hash_map_match(ctrl, FLAT_HASH_MAP_EMPTY))
+                return INVALID_INDEX;
+
+            group = (group + i + 1) & (GROUP_COUNT - 1);
+        }
+
+        return INVALID_INDEX;
+    }
+
+    // Returns the first empty or deleted slot along the probe sequence of 'hash', or INVALID_INDEX if the map is full.
+    uint32_t find_free(uint64_t hash)
+    {
+        uint32_t group = first_group(hash);
+
+        for (uint32_t i = 0; i < GROUP_COUNT; i++)
+        {
+            uint32_t mask = flat_hash_map_match_free(&m_ctrl[group * FLAT_HASH_MAP_GROUP_SIZE]);
+
+            if (mask)
+                return group * FLAT_HASH_MAP_GROUP_SIZE + flat_hash_map_lowest_bit(mask);
+
+            group = (group + i + 1) & (GROUP_COUNT - 1);
+        }
+
+        return INVALID_INDEX;
+    }
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Growable counterpart of StaticFlatHashMap. When the table gets too full, a new one of twice the size is allocated but the
+// entries are moved over FLAT_HASH_MAP_MIGRATE_SLOTS at a time on each following insert or remove, so no single call pays for
+// the whole rehash. Lookups check both tables while a migration is in progress. Pointers returned by get_ptr() are only valid
+// until the next insert or remove. KEY needs operator==.
+template <typename KEY, typename VALUE>
+class FlatHashMap
+{
+public:
+    struct Slot
+    {
+        KEY   key;
+        VALUE value;
+    };
+
+    struct Table
+    {
+        std::vector<int8_t> ctrl;
+        std::vector<Slot>   slots;
+        uint32_t            capacity    = 0;
+        uint32_t            num_objects = 0;
+        uint32_t            num_deleted = 0;
+    };
+
+    Table          m_table;
+    Table          m_old_table;
+    uint32_t       m_migrate_index = 0;
+    const uint32_t INVALID_INDEX   = 0xffffffffu;
+
+public:
+    // 'initial_capacity' is rounded up to a power of two of at least 16.
+    FlatHashMap(uint32_t initial_capacity = 64)
+    {
+        allocate(m_table, initial_capacity);
+    }
+
+    ~FlatHashMap()
+    {
+    }
+
+    void set(const KEY& key, const VALUE& value)
+    {
+        uint64_t hash  = create_hash(key);
+        uint32_t index = find(m_table, key, hash);
+
+        if (index != INVALID_INDEX)
+            m_table.slots[index].value = value;
+        else if (migrating() && (index = find(m_old_table, key, hash)) != INVALID_INDEX)
+            m_old_table.slots[index].value = value;
+        else
+        {
+            if (m_table.num_objects + m_table.num_deleted + 1 > max_load(m_table))
+                grow();
+
+            index                      = insert(m_table, key, hash);
+            m_table.slots[index].value = value;
+        }
+
+        migrate();
+    }
+
+    bool has(const KEY& key)
+    {
+        return get_ptr(key) != nullptr;
+    }
+
+    bool get(const KEY& key, VALUE& object)
+    {
+        VALUE* ptr = get_ptr(key);
+
+        if (!ptr)
+            return false;
+        else
+        {
+            object = *ptr;
+            return true;
+        }
+    }
+
+    VALUE* get_ptr(const KEY& key)
+    {
+        uint64_t hash  = create_hash(key);
+        uint32_t index = find(m_table, key, hash);
+
+        if (index != INVALID_INDEX)
+            return &m_table.slots[index].value;
+
+        if (migrating() && (index = find(m_old_table, key, hash)) != INVALID_INDEX)
+            return &m_old_table.slots[index].value;
+
+        return nullptr;
+    }
+
+    void remove(const KEY& key)
+    {
+        uint64_t hash  = create_hash(key);
+        uint32_t index = find(m_table, key, hash);
+
+        if (index != INVALID_INDEX)
+            erase(m_table, index);
+        else if (migrating() && (index = find(m_old_table, key, hash)) != INVALID_INDEX)
+            erase(m_old_table, index);
+
+        migrate();
+    }
+
+    // Keeps the current capacity.
+    void clear()
+    {
+        m_old_table     = Table();
+        m_migrate_index = 0;
+
+        memset(m_table.ctrl.data(), FLAT_HASH_MAP_EMPTY, m_table.capacity);
+
+        for (auto& slot : m_table.slots)
+            slot = Slot();
+
+        m_table.num_objects = 0;
+        m_table.num_deleted = 0;
+    }
+
+    uint32_t size()
+    {
+        return m_table.num_objects + m_old_table.num_objects;
+    }
+
+    uint32_t capacity()
+    {
+        return m_table.capacity;
+    }
+
+private:
+    static inline int8_t tag(uint64_t hash)
+    {
+        return int8_t(hash & 0x7f);
+    }
+
+    static inline uint32_t max_load(const Table& table)
+    {
+        return table.capacity - table.capacity / 8;
+    }
+
+    inline bool migrating()
+    {
+        return m_old_table.capacity > 0;
+    }
+
+    static void allocate(Table& table, uint32_t capacity)
+    {
+        uint32_t size = FLAT_HASH_MAP_GROUP_SIZE;
+
+        while (size < capacity)
+            size *= 2;
+
+        table.ctrl.assign(size, FLAT_HASH_MAP_EMPTY);
+        table.slots.assign(size, Slot());
+        table.capacity    = size;
+        table.num_objects = 0;
+        table.num_deleted = 0;
+    }
+
+    uint32_t find(Table& table, const KEY& key, uint64_t hash)
+    {
+        uint32_t group_count = table.capacity / FLAT_HASH_MAP_GROUP_SIZE;
+        uint32_t group       = uint32_t(hash >> 7) & (group_count - 1);
+        int8_t   t           = tag(hash);
+
+        for (uint32_t i = 0; i < group_count; i++)
+        {
+            const int8_t* ctrl = &table.ctrl[group * FLAT_HASH_MAP_GROUP_SIZE];
+            uint32_t      mask = flat_hash_map_match(ctrl, t);
+
+            while (mask)
+            {
+                uint32_t index = group * FLAT_HASH_MAP_GROUP_SIZE + flat_hash_map_lowest_bit(mask);
+
+                if (table.slots[index].key == key)
+                    return index;
+
+                mask &= mask - 1;
+            }
+
+            if (flat_hash_map_match(ctrl, FLAT_HASH_MAP_EMPTY))
+                return INVALID_INDEX;
+
+            group = (group + i + 1) & (group_count - 1);
+        }
+
+        return INVALID_INDEX;
+    }
+
+    // Claims a free slot for a key that is known not to be in the table. The load factor check keeps one available.
+    uint32_t insert(Table& table, const KEY& key, uint64_t hash)
+    {
+        uint32_t group_count = table.capacity / FLAT_HASH_MAP_GROUP_SIZE;
+        uint32_t group       = uint32_t(hash >> 7) & (group_count - 1);
+        uint32_t mask        = flat_hash_map_match_free(&table.ctrl[group * FLAT_HASH_MAP_GROUP_SIZE]);
+
+        for (uint32_t i = 0; mask == 0; i++)
+        {
+            group = (group + i + 1) & (group_count - 1);
+            mask  = flat_hash_map_match_free(&table.ctrl[group * FLAT_HASH_MAP_GROUP_SIZE]);
+        }
+
+        uint32_t index = group * FLAT_HASH_MAP_GROUP_SIZE + flat_hash_map_lowest_bit(mask);
+
+        if (table.ctrl[index] == FLAT_HASH_MAP_DELETED)
+            table.num_deleted--;
+
+        table.ctrl[index]      = tag(hash);
+        table.slots[index].key = key;
+        table.num_objects++;
+
+        return index;
+    }
+
+    void erase(Table& table, uint32_t index)
+    {
+        const int8_t* group = &table.ctrl[index & ~(FLAT_HASH_MAP_GROUP_SIZE - 1)];
+
+        if (flat_hash_map_match(group, FLAT_HASH_MAP_EMPTY))
+            table.ctrl[index] = FLAT_HASH_MAP_EMPTY;
+        else
+        {
+            table.ctrl[index] = FLAT_HASH_MAP_DELETED;
+            table.num_deleted++;
+        }
+
+        table.slots[index] = Slot();
+        table.num_objects--;
+    }
+
+    void grow()
+    {
+        // A previous migration normally finishes long before the new table fills up. Make sure anyway.
+        while (migrating())
+            migrate();
+
+        // If most of the load is tombstones, rehashing at the same size is enough to get rid of them.
+        uint32_t capacity = m_table.num_objects >= m_table.capacity / 2 ? m_table.capacity * 2 : m_table.capacity;
+
+        m_old_table     = std::move(m_table);
+        m_table         = Table();
+        m_migrate_index = 0;
+
+        allocate(m_table, capacity);
+    }
+
+    void migrate()
+    {
+        if (!migrating())
+            return;
+
+        uint32_t end = m_migrate_index + FLAT_HASH_MAP_MIGRATE_SLOTS;
+
+        if (end > m_old_table.capacity)
+            end = m_old_table.capacity;
+
+        for (; m_migrate_index < end; m_migrate_index++)
+        {
+            if (m_old_table.ctrl[m_migrate_index] < 0)
+                continue;
+
+            Slot&    slot  = m_old_table.slots[m_migrate_index];
+            uint32_t index = insert(m_table, slot.key, create_hash(slot.key));
+
+            m_table.slots[index].value = std::move(slot.value);
+
+            // Entries that haven't moved yet may probe through this slot, so it has to stay a tombstone.
+            m_old_table.ctrl[m_migrate_index] = FLAT_HASH_MAP_DELETED;
+            m_old_table.num_objects--;
+        }
+
+        if (m_migrate_index == m_old_table.capacity)
+        {
+            m_old_table     = Table();
+            m_migrate_index = 0;
+        }
+    }
+};
+} // namespace inferno
@@ -0,0 +1,193 @@
+#include "frame_allocator.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace inferno
+{
+namespace frame_allocator
+{
+struct Page
+{
+    uint8_t* data;
+    size_t   size;
+};
+
+struct Region
+{
+    std::vector<Page> pages;
+    size_t            page_index = 0;
+    size_t            offset     = 0;
+};
+
+struct ThreadArena
+{
+    Region   regions[FRAME_ALLOCATOR_FRAME_COUNT];
+    Region*  current = &regions[0];
+    uint64_t frame   = 0;
+
+    ~ThreadArena()
+    {
+        for (auto& region : regions)
+        {
+            for (auto& page : region.pages)
+                free(page.data);
+        }
+    }
+};
+
+std::atomic<uint64_t>    g_frame(0);
+std::atomic<uint64_t>    g_heap_allocations(0);
+std::atomic<uint64_t>    g_heap_allocations_last_frame(0);
+uint64_t                 g_heap_allocations_at_frame_start = 0;
+thread_local ThreadArena g_arena;
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void* allocate_page(Region& region, size_t size)
+{
+    Page page;
+
+    page.size = size > FRAME_ALLOCATOR_PAGE_SIZE ? size : FRAME_ALLOCATOR_PAGE_SIZE;
+    page.data = static_cast<uint8_t*>(malloc(page.size));
+
+    if (!page.data)
+        throw std::bad_alloc();
+
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    region.pages.push_back(page);
+    region.page_index = region.pages.size() - 1;
+    region.offset     = 0;
+
+    return page.data;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void next_frame()
+{
+    uint64_t count = g_heap_allocations.load(std::memory_order_relaxed);
+
+    g_heap_allocations_last_frame.store(count - g_heap_allocations_at_frame_start, std::memory_order_relaxed);
+    g_heap_allocations_at_frame_start = count;
+
+    g_frame.fetch_add(1, std::memory_order_release);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void* allocate(size_t size, size_t alignment)
+{
+    ThreadArena& arena = g_arena;
+    uint64_t     frame = g_frame.load(std::memory_order_acquire);
+
+    if (frame != arena.frame)
+    {
+        arena.frame               = frame;
+        arena.current             = &arena.regions[frame % FRAME_ALLOCATOR_FRAME_COUNT];
+        arena.current->page_index = 0;
+        arena.current->offset     = 0;
+    }
+
+    Region& region = *arena.current;
+
+    // Walk the pages kept from earlier frames before growing the region.
+    while (region.page_index < region.pages.size())
+    {
+        Page&     page   = region.pages[region.page_index];
+        uintptr_t base   = reinterpret_cast<uintptr_t>(page.data);
+        size_t    offset = ((base + region.offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+
+        if (offset + size <= page.size)
+        {
+            region.offset = offset + size;
+            return page.data + offset;
+        }
+
+        region.page_index++;
+        region.offset = 0;
+    }
+
+    // malloc() alignment covers everything up to max_align_t; over-aligned requests get some slack.
+    size_t   slack = alignment > alignof(max_align_t) ? alignment : 0;
+    uint8_t* data  = static_cast<uint8_t*>(allocate_page(region, size + slack));
+    size_t   start = ((reinterpret_cast<uintptr_t>(data) + alignment - 1) & ~(uintptr_t(alignment) - 1)) - reinterpret_cast<uintptr_t>(data);
+
+    region.offset = start + size;
+
+    return data + start;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t heap_allocation_count()
+{
+    return g_heap_allocations.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t heap_allocations_last_frame()
+{
+    return g_heap_allocations_last_frame.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace frame_allocator
+} // namespace inferno
+
+#if defined(INFERNO_TRACK_HEAP_ALLOCATIONS)
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void* operator new(size_t size)
+{
+    inferno::frame_allocator::g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = malloc(size ? size : 1);
+
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// Number of frames an allocation stays valid for. Matches the frames the GPU may still be reading from.
+#define FRAME_ALLOCATOR_FRAME_COUNT 3
+#define FRAME_ALLOCATOR_PAGE_SIZE (1024 * 1024)
+
+// Define to route every global operator new/delete through a counter, so heap_allocations_last_frame() covers all heap traffic
+// and not just the allocator's own pages.
+// #define INFERNO_TRACK_HEAP_ALLOCATIONS
+
+namespace inferno
+{
+namespace frame_allocator
+{
+// Starts a new frame. Call once per frame from the main thread before any transient allocations are made for it. Every thread
+// switches over lazily on its next allocation and recycles the region it used FRAME_ALLOCATOR_FRAME_COUNT frames ago.
+extern void next_frame();
+
+// Bump-allocates from the calling thread's region for the current frame. Only grows the heap until each region has seen its
+// peak usage; after that allocations are a pointer bump. Memory must not be used after FRAME_ALLOCATOR_FRAME_COUNT more calls
+// to next_frame(), or after the allocating thread exits.
+extern void* allocate(size_t size, size_t alignment);
+
+// Heap allocations made since startup and during the previous frame.
+extern uint64_t heap_allocation_count();
+extern uint64_t heap_allocations_last_frame();
+} // namespace frame_allocator
+
+// STL allocator on top of the frame allocator. Deallocation is a no-op; memory is reclaimed when the frame region is recycled.
+template <typename T>
+struct FrameAllocatorAdapter
+{
+    using value_type = T;
+
+    FrameAllocatorAdapter() {}
+
+    template <typename U>
+    FrameAllocatorAdapter(const FrameAllocatorAdapter<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(frame_allocator::allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocatorAdapter<T>&, const FrameAllocatorAdapter<U>&) { return true; }
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocatorAdapter<T>&, const FrameAllocatorAdapter<U>&) { return false; }
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocatorAdapter<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocatorAdapter<char>>;
+} // namespace inferno
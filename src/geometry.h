@@ -163,6 +163,52 @@ inline float classify(const OBB& obb, const Plane& plane)
     return d - r;
 }
 
+// Writes the 8 world-space corners of an OBB. 'min' and 'max' are the local extents, 'position' the world-space center.
+inline void obb_corners(const OBB& obb, glm::vec3* corners)
+{
+    glm::vec3 center = (obb.max + obb.min) * 0.5f;
+
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 local = glm::vec3((i & 1) ? obb.max.x : obb.min.x,
+                                    (i & 2) ? obb.max.y : obb.min.y,
+                                    (i & 4) ? obb.max.z : obb.min.z);
+
+        corners[i] = obb.position + obb.orientation * (local - center);
+    }
+}
+
+inline AABB aabb_from_obb(const OBB& obb)
+{
+    glm::vec3 corners[8];
+    obb_corners(obb, corners);
+
+    AABB aabb = { corners[0], corners[0] };
+
+    for (int i = 1; i < 8; i++)
+    {
+        aabb.min = glm::min(aabb.min, corners[i]);
+        aabb.max = glm::max(aabb.max, corners[i]);
+    }
+
+    return aabb;
+}
+
+// Slab test. Returns the entry and exit distances along the ray, which may be negative if the origin is inside or past the box.
+inline bool intersects(const Ray& ray, const AABB& aabb, float& t_enter, float& t_exit)
+{
+    glm::vec3 inv_dir = 1.0f / ray.direction;
+    glm::vec3 t0      = (aabb.min - ray.origin) * inv_dir;
+    glm::vec3 t1      = (aabb.max - ray.origin) * inv_dir;
+    glm::vec3 t_near  = glm::min(t0, t1);
+    glm::vec3 t_far   = glm::max(t0, t1);
+
+    t_enter = fmaxf(fmaxf(t_near.x, t_near.y), t_near.z);
+    t_exit  = fminf(fminf(t_far.x, t_far.y), t_far.z);
+
+    return t_exit >= fmaxf(t_enter, 0.0f);
+}
+
 inline bool intersects(const Frustum& f, const Sphere& s)
 {
     for (int i = 0; i < 6; ++i)
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_GENERATION_BITS (32 - HANDLE_INDEX_BITS)
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GENERATION_MASK ((1u << HANDLE_GENERATION_BITS) - 1)
+#define HANDLE_POOL_CHUNK_SIZE 256
+
+namespace inferno
+{
+// 32-bit reference to an object in a HandlePool<T>: the lower HANDLE_INDEX_BITS select a slot, the upper bits hold the generation
+// of that slot when the object was created. Trivially copyable, so passing one around costs nothing, and a handle that outlived
+// its object simply fails to resolve. The default value never resolves.
+template <typename T>
+struct Handle
+{
+    uint32_t value = 0;
+
+    Handle() {}
+    explicit Handle(uint32_t v) :
+        value(v) {}
+
+    inline uint32_t index() const { return value & HANDLE_INDEX_MASK; }
+    inline uint32_t generation() const { return value >> HANDLE_INDEX_BITS; }
+    inline bool     is_null() const { return value == 0; }
+
+    inline bool operator==(const Handle& other) const { return value == other.value; }
+    inline bool operator!=(const Handle& other) const { return value != other.value; }
+};
+
+// Owns objects of one type and hands out generational handles to them. Objects are constructed in place inside fixed-size
+// chunks, so one allocate() costs no heap allocation unless a new chunk is needed, and pointers returned by get() stay valid
+// until the object is released. Lifetime is explicit: an object lives until release() or until the pool is destroyed.
+// Not thread-safe.
+template <typename T>
+class HandlePool
+{
+public:
+    HandlePool() :
+        m_num_slots(0), m_num_alive(0) {}
+
+    ~HandlePool()
+    {
+        clear();
+    }
+
+    HandlePool(const HandlePool&) = delete;
+    HandlePool& operator=(const HandlePool&) = delete;
+
+    template <typename... Args>
+    Handle<T> allocate(Args&&... args)
+    {
+        uint32_t index;
+
+        if (!m_free.empty())
+            index = m_free.back();
+        else
+        {
+            if (m_num_slots == HANDLE_INDEX_MASK + 1)
+                throw std::bad_alloc();
+
+            if (m_num_slots % HANDLE_POOL_CHUNK_SIZE == 0)
+                m_chunks.push_back(std::unique_ptr<Slot[]>(new Slot[HANDLE_POOL_CHUNK_SIZE]));
+
+            index = m_num_slots;
+        }
+
+        Slot& s = slot(index);
+
+        // Construct before taking the slot so a throwing constructor leaves the pool untouched.
+        new (&s.storage) T(std::forward<Args>(args)...);
+
+        if (index == m_num_slots)
+            m_num_slots++;
+        else
+            m_free.pop_back();
+
+        s.alive = true;
+        m_num_alive++;
+
+        return Handle<T>((s.generation << HANDLE_INDEX_BITS) | index);
+    }
+
+    // Destroys the object and invalidates every handle to it. Releasing a stale or null handle does nothing.
+    void release(Handle<T> handle)
+    {
+        T* object = get(handle);
+
+        if (!object)
+            return;
+
+        Slot& s = slot(handle.index());
+
+        object->~T();
+
+        s.alive = false;
+        // Generation 0 is skipped on wrap-around so that the null handle never becomes valid.
+        s.generation = (s.generation & HANDLE_GENERATION_MASK) == HANDLE_GENERATION_MASK ? 1 : s.generation + 1;
+
+        m_free.push_back(handle.index());
+        m_num_alive--;
+    }
+
+    // Returns nullptr for null, stale or released handles.
+    inline T* get(Handle<T> handle)
+    {
+        uint32_t index = handle.index();
+
+        if (index >= m_num_slots)
+            return nullptr;
+
+        Slot& s = slot(index);
+
+        if (!s.alive || s.generation != handle.generation())
+            return nullptr;
+
+        return reinterpret_cast<T*>(&s.storage);
+    }
+
+    inline bool valid(Handle<T> handle)
+    {
+        return get(handle) != nullptr;
+    }
+
+    inline uint32_t size()
+    {
+        return m_num_alive;
+    }
+
+    // Destroys every live object. Generations keep counting, so handles from before the clear stay invalid.
+    void clear()
+    {
+        for (uint32_t i = 0; i < m_num_slots; i++)
+        {
+            Slot& s = slot(i);
+
+            if (s.alive)
+                release(Handle<T>((s.generation << HANDLE_INDEX_BITS) | i));
+        }
+    }
+
+private:
+    struct Slot
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        uint32_t                                                   generation = 1;
+        bool                                                       alive      = false;
+    };
+
+    inline Slot& slot(uint32_t index)
+    {
+        return m_chunks[index / HANDLE_POOL_CHUNK_SIZE][index % HANDLE_POOL_CHUNK_SIZE];
+    }
+
+private:
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    std::vector<uint32_t>                m_free;
+    uint32_t                             m_num_slots;
+    uint32_t                             m_num_alive;
+};
+} // namespace inferno
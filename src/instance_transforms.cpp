@@ -0,0 +1,182 @@
+#include "instance_transforms.h"
+#include "camera.h"
+#include "entity.h"
+#include "draw_list.h"
+#include "logger.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define INSTANCE_TRANSFORMS_SSE
+#endif
+
+// Matrices with a smaller determinant are treated as degenerate and get an identity normal matrix.
+#define MIN_NORMAL_MATRIX_DETERMINANT 1e-12f
+
+namespace inferno
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+#if defined(INSTANCE_TRANSFORMS_SSE)
+
+// out = a * b for column-major 4x4 matrices, streamed straight to 'out'.
+static inline void multiply(const float* a, const float* b, float* out)
+{
+    __m128 a0 = _mm_loadu_ps(a + 0);
+    __m128 a1 = _mm_loadu_ps(a + 4);
+    __m128 a2 = _mm_loadu_ps(a + 8);
+    __m128 a3 = _mm_loadu_ps(a + 12);
+
+    for (int i = 0; i < 4; i++)
+    {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[i * 4 + 0]));
+        r        = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[i * 4 + 1])));
+        r        = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[i * 4 + 2])));
+        r        = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[i * 4 + 3])));
+
+        _mm_stream_ps(out + i * 4, r);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void copy(const float* src, float* out)
+{
+    for (int i = 0; i < 4; i++)
+        _mm_stream_ps(out + i * 4, _mm_loadu_ps(src + i * 4));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline __m128 cross(__m128 a, __m128 b)
+{
+    __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c     = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Inverse-transpose of the upper 3x3. Its columns are the cross products of the model columns divided by the determinant.
+static inline void normal_matrix(const float* model, float* out)
+{
+    __m128 c0 = _mm_loadu_ps(model + 0);
+    __m128 c1 = _mm_loadu_ps(model + 4);
+    __m128 c2 = _mm_loadu_ps(model + 8);
+
+    __m128 n0 = cross(c1, c2);
+    __m128 n1 = cross(c2, c0);
+    __m128 n2 = cross(c0, c1);
+
+    __m128 d   = _mm_mul_ps(c0, n0);
+    float  det = _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2))));
+
+    if (fabsf(det) < MIN_NORMAL_MATRIX_DETERMINANT)
+    {
+        _mm_stream_ps(out + 0, _mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f));
+        _mm_stream_ps(out + 4, _mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f));
+        _mm_stream_ps(out + 8, _mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f));
+        return;
+    }
+
+    __m128 inv_det = _mm_set1_ps(1.0f / det);
+
+    // The cross products leave W at zero, which is what std430 padding expects.
+    _mm_stream_ps(out + 0, _mm_mul_ps(n0, inv_det));
+    _mm_stream_ps(out + 4, _mm_mul_ps(n1, inv_det));
+    _mm_stream_ps(out + 8, _mm_mul_ps(n2, inv_det));
+}
+
+#else
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void multiply(const float* a, const float* b, float* out)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+            out[i * 4 + j] = a[j] * b[i * 4 + 0] + a[4 + j] * b[i * 4 + 1] + a[8 + j] * b[i * 4 + 2] + a[12 + j] * b[i * 4 + 3];
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void copy(const float* src, float* out)
+{
+    for (int i = 0; i < 16; i++)
+        out[i] = src[i];
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline void normal_matrix(const float* model, float* out)
+{
+    glm::vec3 c0 = glm::vec3(model[0], model[1], model[2]);
+    glm::vec3 c1 = glm::vec3(model[4], model[5], model[6]);
+    glm::vec3 c2 = glm::vec3(model[8], model[9], model[10]);
+
+    glm::vec3 n[3] = { glm::cross(c1, c2), glm::cross(c2, c0), glm::cross(c0, c1) };
+    float     det  = glm::dot(c0, n[0]);
+
+    for (int i = 0; i < 3; i++)
+    {
+        glm::vec3 column = fabsf(det) < MIN_NORMAL_MATRIX_DETERMINANT ? glm::vec3(i == 0, i == 1, i == 2) : n[i] / det;
+
+        out[i * 4 + 0] = column.x;
+        out[i * 4 + 1] = column.y;
+        out[i * 4 + 2] = column.z;
+        out[i * 4 + 3] = 0.0f;
+    }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+vk::Buffer::Ptr create_instance_transform_buffer(vk::Backend::Ptr backend, uint32_t frame_count)
+{
+    return vk::Buffer::create(backend, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, sizeof(InstanceTransforms) * MAX_ENTITIES * frame_count, VMA_MEMORY_USAGE_CPU_TO_GPU, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+InstanceTransforms* instance_transforms_for_frame(vk::Buffer::Ptr buffer, uint32_t frame_index)
+{
+    return static_cast<InstanceTransforms*>(buffer->mapped_ptr()) + size_t(frame_index) * MAX_ENTITIES;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void build_instance_transforms(const Camera& camera, const DrawList& list, Entity* entities, InstanceTransforms* dst)
+{
+    if ((reinterpret_cast<uintptr_t>(dst) & 15) != 0)
+    {
+        INFERNO_LOG_ERROR("(InstanceTransforms) Destination is not 16-byte aligned.");
+        return;
+    }
+
+    const float* view_projection      = &camera.m_view_projection[0][0];
+    const float* prev_view_projection = &camera.m_prev_view_projection[0][0];
+
+    for (uint32_t i = 0; i < list.count; i++)
+    {
+        const Transform&    transform = entities[list.items[i].entity_index].transform;
+        InstanceTransforms& out       = dst[i];
+
+        copy(&transform.model[0][0], &out.model[0][0]);
+        multiply(view_projection, &transform.model[0][0], &out.model_view_projection[0][0]);
+        multiply(prev_view_projection, &transform.prev_model[0][0], &out.prev_model_view_projection[0][0]);
+        normal_matrix(&transform.model[0][0], &out.normal_matrix[0][0]);
+    }
+
+#if defined(INSTANCE_TRANSFORMS_SSE)
+    // Streaming stores are weakly ordered. Make them visible before the command buffer referencing them is submitted.
+    _mm_sfence();
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
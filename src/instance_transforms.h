@@ -0,0 +1,34 @@
+#pragma once
+
+#include "vk.h"
+#include <glm.hpp>
+#include <stdint.h>
+
+namespace inferno
+{
+struct Camera;
+struct Entity;
+struct DrawList;
+
+// Per-draw matrices in std430 layout. A mat3 would be padded to three vec4 columns anyway, so the normal matrix is stored
+// that way explicitly. 240 bytes, a multiple of 16 so consecutive entries stay aligned.
+struct InstanceTransforms
+{
+    glm::mat4 model;
+    glm::mat4 model_view_projection;
+    glm::mat4 prev_model_view_projection;
+    glm::vec4 normal_matrix[3];
+};
+
+static_assert(sizeof(InstanceTransforms) == 240, "InstanceTransforms must match the std430 layout used by the shaders.");
+
+// Creates a persistently mapped storage buffer holding MAX_ENTITIES instances for each of 'frame_count' frames.
+extern vk::Buffer::Ptr create_instance_transform_buffer(vk::Backend::Ptr backend, uint32_t frame_count);
+
+// Returns the first instance of the region that belongs to 'frame_index' in a buffer created by the function above.
+extern InstanceTransforms* instance_transforms_for_frame(vk::Buffer::Ptr buffer, uint32_t frame_index);
+
+// Computes the matrices of every item in the draw list, in list order, and writes them to 'dst'. Run after culling and
+// build_draw_list(). 'dst' must be 16-byte aligned; writes bypass the cache since the memory is only read by the GPU.
+extern void build_instance_transforms(const Camera& camera, const DrawList& list, Entity* entities, InstanceTransforms* dst);
+} // namespace inferno
@@ -0,0 +1,281 @@
+#include "light_culling.h"
+#include "lights.h"
+#include <float.h>
+#include <math.h>
+
+#if defined(__AVX__)
+#    include <immintrin.h>
+#    define LIGHT_CULLING_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define LIGHT_CULLING_SSE
+#endif
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+// Spot cones wider than this are bounded by their sphere alone, since tan() blows up towards 90 degrees.
+#define MAX_CONE_TEST_ANGLE 89.0f
+
+namespace inferno
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline uint32_t count_trailing_zeros(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Appends the lane indices of all set bits in 'mask'.
+static inline void compact(uint32_t mask, uint32_t base, uint16_t* indices, uint32_t& count)
+{
+    while (mask)
+    {
+        indices[count++] = uint16_t(base + count_trailing_zeros(mask));
+        mask &= mask - 1;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+#if defined(LIGHT_CULLING_AVX)
+
+typedef __m256 vfloat;
+
+#    define LIGHT_CULLING_LANES 8
+
+static inline vfloat   vload(const float* p) { return _mm256_load_ps(p); }
+static inline vfloat   vset1(float v) { return _mm256_set1_ps(v); }
+static inline vfloat   vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat   vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat   vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat   vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+static inline vfloat   vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+static inline vfloat   vand(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+static inline vfloat   vor(vfloat a, vfloat b) { return _mm256_or_ps(a, b); }
+static inline vfloat   vcmpge(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+static inline vfloat   vtrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+static inline uint32_t vmask(vfloat a) { return uint32_t(_mm256_movemask_ps(a)); }
+
+#elif defined(LIGHT_CULLING_SSE)
+
+typedef __m128 vfloat;
+
+#    define LIGHT_CULLING_LANES 4
+
+static inline vfloat   vload(const float* p) { return _mm_load_ps(p); }
+static inline vfloat   vset1(float v) { return _mm_set1_ps(v); }
+static inline vfloat   vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat   vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat   vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat   vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+static inline vfloat   vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+static inline vfloat   vand(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+static inline vfloat   vor(vfloat a, vfloat b) { return _mm_or_ps(a, b); }
+static inline vfloat   vcmpge(vfloat a, vfloat b) { return _mm_cmpge_ps(a, b); }
+static inline vfloat   vtrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+static inline uint32_t vmask(vfloat a) { return uint32_t(_mm_movemask_ps(a)); }
+
+#else
+
+// Scalar fallback with the same interface so the kernels below compile everywhere.
+typedef float vfloat;
+
+#    define LIGHT_CULLING_LANES 1
+
+static inline vfloat   vload(const float* p) { return *p; }
+static inline vfloat   vset1(float v) { return v; }
+static inline vfloat   vadd(vfloat a, vfloat b) { return a + b; }
+static inline vfloat   vmul(vfloat a, vfloat b) { return a * b; }
+static inline vfloat   vsub(vfloat a, vfloat b) { return a - b; }
+static inline vfloat   vmax(vfloat a, vfloat b) { return a > b ? a : b; }
+static inline vfloat   vsqrt(vfloat a) { return sqrtf(a); }
+static inline vfloat   vand(vfloat a, vfloat b) { return (a != 0.0f && b != 0.0f) ? 1.0f : 0.0f; }
+static inline vfloat   vor(vfloat a, vfloat b) { return (a != 0.0f || b != 0.0f) ? 1.0f : 0.0f; }
+static inline vfloat   vcmpge(vfloat a, vfloat b) { return a >= b ? 1.0f : 0.0f; }
+static inline vfloat   vtrue() { return 1.0f; }
+static inline uint32_t vmask(vfloat a) { return a != 0.0f ? 1u : 0u; }
+
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void prepare_point_light_bounds(PointLightBounds& bounds, PointLight* lights, uint32_t count)
+{
+    bounds.count = count;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PointLight& light = lights[i];
+
+        bounds.x[i]      = light.transform.position.x;
+        bounds.y[i]      = light.transform.position.y;
+        bounds.z[i]      = light.transform.position.z;
+        bounds.radius[i] = light.enabled ? light.range : -FLT_MAX;
+    }
+
+    // Pad the tail so the last batch can be loaded whole.
+    for (uint32_t i = count; i < count + LIGHT_CULLING_BATCH_SIZE; i++)
+    {
+        bounds.x[i]      = 0.0f;
+        bounds.y[i]      = 0.0f;
+        bounds.z[i]      = 0.0f;
+        bounds.radius[i] = -FLT_MAX;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void prepare_spot_light_bounds(SpotLightBounds& bounds, SpotLight* lights, uint32_t count)
+{
+    bounds.count = count;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        SpotLight& light = lights[i];
+        glm::vec3  dir   = glm::normalize(light.transform.forward());
+        bool       wide  = light.outer_cone_angle > MAX_CONE_TEST_ANGLE;
+
+        bounds.x[i]           = light.transform.position.x;
+        bounds.y[i]           = light.transform.position.y;
+        bounds.z[i]           = light.transform.position.z;
+        bounds.dir_x[i]       = dir.x;
+        bounds.dir_y[i]       = dir.y;
+        bounds.dir_z[i]       = dir.z;
+        bounds.range[i]       = light.enabled ? light.range : -FLT_MAX;
+        bounds.height[i]      = light.enabled ? light.range : 0.0f;
+        bounds.base_radius[i] = light.enabled && !wide ? light.range * tanf(glm::radians(light.outer_cone_angle)) : 0.0f;
+        bounds.sphere_only[i] = wide ? 1.0f : 0.0f;
+    }
+
+    for (uint32_t i = count; i < count + LIGHT_CULLING_BATCH_SIZE; i++)
+    {
+        bounds.x[i]           = 0.0f;
+        bounds.y[i]           = 0.0f;
+        bounds.z[i]           = 0.0f;
+        bounds.dir_x[i]       = 0.0f;
+        bounds.dir_y[i]       = 0.0f;
+        bounds.dir_z[i]       = 1.0f;
+        bounds.range[i]       = -FLT_MAX;
+        bounds.height[i]      = 0.0f;
+        bounds.base_radius[i] = 0.0f;
+        bounds.sphere_only[i] = 0.0f;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void cull_point_lights(const Frustum& frustum, const PointLightBounds& bounds, VisibleLights& out)
+{
+    out.point_light_count = 0;
+
+    for (uint32_t i = 0; i < bounds.count; i += LIGHT_CULLING_LANES)
+    {
+        vfloat x       = vload(&bounds.x[i]);
+        vfloat y       = vload(&bounds.y[i]);
+        vfloat z       = vload(&bounds.z[i]);
+        vfloat neg_r   = vsub(vset1(0.0f), vload(&bounds.radius[i]));
+        vfloat visible = vtrue();
+
+        for (int p = 0; p < 6; p++)
+        {
+            const Plane& plane = frustum.planes[p];
+
+            vfloat dist = vadd(vadd(vmul(x, vset1(plane.normal.x)), vmul(y, vset1(plane.normal.y))), vadd(vmul(z, vset1(plane.normal.z)), vset1(plane.distance)));
+            visible     = vand(visible, vcmpge(dist, neg_r));
+        }
+
+        uint32_t mask = vmask(visible);
+
+        // Drop lanes past the end that belong to the padding.
+        if (i + LIGHT_CULLING_LANES > bounds.count)
+            mask &= (1u << (bounds.count - i)) - 1u;
+
+        compact(mask, i, &out.point_light_indices[0], out.point_light_count);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void cull_spot_lights(const Frustum& frustum, const SpotLightBounds& bounds, VisibleLights& out)
+{
+    out.spot_light_count = 0;
+
+    vfloat zero = vset1(0.0f);
+    vfloat one  = vset1(1.0f);
+
+    for (uint32_t i = 0; i < bounds.count; i += LIGHT_CULLING_LANES)
+    {
+        vfloat x       = vload(&bounds.x[i]);
+        vfloat y       = vload(&bounds.y[i]);
+        vfloat z       = vload(&bounds.z[i]);
+        vfloat dx      = vload(&bounds.dir_x[i]);
+        vfloat dy      = vload(&bounds.dir_y[i]);
+        vfloat dz      = vload(&bounds.dir_z[i]);
+        vfloat neg_r   = vsub(zero, vload(&bounds.range[i]));
+        vfloat h       = vload(&bounds.height[i]);
+        vfloat base_r  = vload(&bounds.base_radius[i]);
+        vfloat no_cone = vcmpge(vload(&bounds.sphere_only[i]), one);
+        vfloat visible = vtrue();
+
+        for (int p = 0; p < 6; p++)
+        {
+            const Plane& plane = frustum.planes[p];
+
+            vfloat nx = vset1(plane.normal.x);
+            vfloat ny = vset1(plane.normal.y);
+            vfloat nz = vset1(plane.normal.z);
+
+            // Signed distance of the apex.
+            vfloat apex_dist = vadd(vadd(vmul(x, nx), vmul(y, ny)), vadd(vmul(z, nz), vset1(plane.distance)));
+
+            // The point of the base rim farthest along the plane normal is apex + h * dir + r * normalize(n - dot(n, dir) * dir).
+            // With unit vectors its distance reduces to apex_dist + h * dot(n, dir) + r * sqrt(1 - dot(n, dir)^2).
+            vfloat n_dot_d   = vadd(vadd(vmul(dx, nx), vmul(dy, ny)), vmul(dz, nz));
+            vfloat sin_theta = vsqrt(vmax(vsub(one, vmul(n_dot_d, n_dot_d)), zero));
+            vfloat rim_dist  = vadd(apex_dist, vadd(vmul(h, n_dot_d), vmul(base_r, sin_theta)));
+
+            // The cone is outside only if both the apex and the farthest rim point are behind the plane. Lanes that are too wide
+            // for the cone test always pass it.
+            vfloat cone_inside   = vor(no_cone, vor(vcmpge(apex_dist, zero), vcmpge(rim_dist, zero)));
+            vfloat sphere_inside = vcmpge(apex_dist, neg_r);
+
+            visible = vand(visible, vand(cone_inside, sphere_inside));
+        }
+
+        uint32_t mask = vmask(visible);
+
+        if (i + LIGHT_CULLING_LANES > bounds.count)
+            mask &= (1u << (bounds.count - i)) - 1u;
+
+        compact(mask, i, &out.spot_light_indices[0], out.spot_light_count);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void cull_lights(const Frustum& frustum, const PointLightBounds& point_lights, const SpotLightBounds& spot_lights, VisibleLights& out)
+{
+    cull_point_lights(frustum, point_lights, out);
+    cull_spot_lights(frustum, spot_lights, out);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void cull_lights(const Frustum* frustums, uint32_t view_count, const PointLightBounds& point_lights, const SpotLightBounds& spot_lights, VisibleLights* out)
+{
+    for (uint32_t i = 0; i < view_count; i++)
+        cull_lights(frustums[i], point_lights, spot_lights, out[i]);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "geometry.h"
+#include "constants.h"
+#include "macros.h"
+#include <stdint.h>
+
+// Lights are processed in batches of this many lanes. Arrays are padded to a multiple of it.
+#define LIGHT_CULLING_BATCH_SIZE 8
+
+namespace inferno
+{
+struct PointLight;
+struct SpotLight;
+
+// Structure-of-arrays copy of the point light bounds, laid out for the SIMD kernel.
+struct PointLightBounds
+{
+    uint32_t count = 0;
+    INFERNO_ALIGNED(32) float x[MAX_POINT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float y[MAX_POINT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float z[MAX_POINT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float radius[MAX_POINT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+};
+
+// Structure-of-arrays copy of the spot light bounding cones, laid out for the SIMD kernel.
+struct SpotLightBounds
+{
+    uint32_t count = 0;
+    INFERNO_ALIGNED(32) float x[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float y[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float z[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float dir_x[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float dir_y[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float dir_z[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    // Bounding sphere radius. Set to -FLT_MAX for disabled lights and padding so they always fail.
+    INFERNO_ALIGNED(32) float range[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float height[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    INFERNO_ALIGNED(32) float base_radius[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+    // 1.0 for cones too wide for the cone test, which are then culled by their bounding sphere alone. 0.0 otherwise.
+    INFERNO_ALIGNED(32) float sphere_only[MAX_SPOT_LIGHTS + LIGHT_CULLING_BATCH_SIZE];
+};
+
+struct VisibleLights
+{
+    uint32_t point_light_count = 0;
+    uint32_t spot_light_count  = 0;
+    uint16_t point_light_indices[MAX_POINT_LIGHTS];
+    uint16_t spot_light_indices[MAX_SPOT_LIGHTS];
+};
+
+// Converts the scene lights into the SoA layouts above. Call once per frame after the light transforms are updated.
+extern void prepare_point_light_bounds(PointLightBounds& bounds, PointLight* lights, uint32_t count);
+extern void prepare_spot_light_bounds(SpotLightBounds& bounds, SpotLight* lights, uint32_t count);
+
+// Tests all lights against a single view frustum and writes the indices of the visible ones.
+extern void cull_lights(const Frustum& frustum, const PointLightBounds& point_lights, const SpotLightBounds& spot_lights, VisibleLights& out);
+
+// Same as above for several views at once, e.g. the main camera, shadow cascades and probe faces. 'out' must hold 'view_count' entries.
+extern void cull_lights(const Frustum* frustums, uint32_t view_count, const PointLightBounds& point_lights, const SpotLightBounds& spot_lights, VisibleLights* out);
+} // namespace inferno
@@ -0,0 +1,90 @@
+#include "lod.h"
+#include "camera.h"
+#include "entity.h"
+#include <algorithm>
+#include <float.h>
+
+namespace inferno
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+float projected_diameter(const Camera& camera, const Sphere& sphere)
+{
+    glm::vec3 d        = sphere.position - camera.m_position;
+    float     distance = glm::dot(d, d) - sphere.radius * sphere.radius;
+
+    // Camera is inside the sphere.
+    if (distance <= 0.0f)
+        return FLT_MAX;
+
+    // m_projection[1][1] is cot(fov / 2), which maps the tangent of the half angle to NDC. NDC spans 2 units, so the diameter in pixels is radius * height.
+    float ndc_radius = (sphere.radius / sqrtf(distance)) * camera.m_projection[1][1];
+
+    return ndc_radius * float(camera.m_height);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void select_lods(const Camera& camera, const LODSettings& settings, Entity* entities, uint32_t entity_count, uint32_t view_index)
+{
+    float scale = powf(2.0f, -settings.bias);
+    float lower = 1.0f - settings.hysteresis;
+    float upper = 1.0f + settings.hysteresis;
+
+    // LOD state is only tracked for the first MAX_VIEWS views.
+    if (view_index >= MAX_VIEWS)
+        return;
+
+    for (uint32_t i = 0; i < entity_count; i++)
+    {
+        Entity& e = entities[i];
+
+        if (!e.visibility(view_index))
+            continue;
+
+        Sphere sphere;
+
+        sphere.position = e.obb.position;
+        sphere.radius   = glm::length(e.obb.max - e.obb.min) * 0.5f;
+
+        float     size = projected_diameter(camera, sphere) * scale;
+        LODChain& lod  = e.lod;
+
+        // Tiny objects are dropped from the view. Once culled they have to grow past the threshold by the hysteresis margin to come back.
+        bool culled = size < settings.cull_threshold * (lod.is_culled(view_index) ? upper : 1.0f);
+
+        if (culled)
+        {
+            SET_BIT_64(lod.culled, view_index);
+            e.set_invisible(view_index);
+            continue;
+        }
+
+        CLEAR_BIT_64(lod.culled, view_index);
+
+        uint32_t level = std::min(lod.selected_level(view_index), lod.level_count - 1);
+
+        // Move to a coarser level only once the size is clearly below the current level's threshold...
+        while (level + 1 < lod.level_count && size < lod.screen_sizes[level] * lower)
+            level++;
+
+        // ...and back to a finer level only once it is clearly above the previous one.
+        while (level > 0 && size > lod.screen_sizes[level - 1] * upper)
+            level--;
+
+        lod.selected[view_index] = uint8_t(level);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void update_lod_bias(LODSettings& settings, float frame_time_ms, float budget_ms)
+{
+    if (frame_time_ms > budget_ms * 1.05f)
+        settings.bias = std::min(settings.bias + settings.bias_step, settings.max_bias);
+    else if (frame_time_ms < budget_ms * 0.9f)
+        settings.bias = std::max(settings.bias - settings.bias_step, 0.0f);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
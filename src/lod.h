@@ -0,0 +1,32 @@
+#pragma once
+
+#include "geometry.h"
+#include <stdint.h>
+
+namespace inferno
+{
+struct Camera;
+struct Entity;
+
+struct LODSettings
+{
+    // Global bias in octaves of screen size. Positive values pick coarser levels.
+    float bias      = 0.0f;
+    float max_bias  = 4.0f;
+    float bias_step = 0.1f;
+    // Fraction a level threshold has to be crossed by before switching, to avoid popping back and forth.
+    float hysteresis = 0.1f;
+    // Objects whose projected diameter falls below this (in pixels) are culled entirely.
+    float cull_threshold = 2.0f;
+};
+
+// Returns the projected diameter of a world-space sphere in pixels. Requires Camera::m_height to be set.
+extern float projected_diameter(const Camera& camera, const Sphere& sphere);
+
+// Selects a level from the LOD chain of every entity visible in 'view_index' and clears the view bit of objects that are too small to draw.
+// The selection is stored per view, so 'view_index' must be less than MAX_VIEWS.
+extern void select_lods(const Camera& camera, const LODSettings& settings, Entity* entities, uint32_t entity_count, uint32_t view_index);
+
+// Nudges the global LOD bias up when the frame is over budget and back down once there is headroom.
+extern void update_lod_bias(LODSettings& settings, float frame_time_ms, float budget_ms);
+} // namespace inferno
@@ -68,4 +68,58 @@ inline uint64_t murmur_hash_64(const void* key, uint32_t len, uint64_t seed)
 
     return h;
 }
+
+// Compile-time version of murmur_hash_64() for strings. Produces the same value as the runtime version on little-endian platforms.
+constexpr uint64_t murmur_hash_64_constexpr(const char* key, uint32_t len, uint64_t seed)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const uint32_t r = 47;
+
+    uint64_t h = seed ^ (len * m);
+
+    uint32_t blocks = len / 8;
+
+    for (uint32_t i = 0; i < blocks; i++)
+    {
+        uint64_t k = 0;
+
+        for (uint32_t j = 0; j < 8; j++)
+            k |= uint64_t(uint8_t(key[i * 8 + j])) << (j * 8);
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    uint32_t tail = len & 7;
+
+    if (tail > 0)
+    {
+        for (uint32_t j = 0; j < tail; j++)
+            h ^= uint64_t(uint8_t(key[blocks * 8 + j])) << (j * 8);
+
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
+
+// "name"_hash yields INFERNO_HASH("name"), computed at compile time when used in a constant expression.
+constexpr uint64_t operator"" _hash(const char* str, size_t len)
+{
+    return murmur_hash_64_constexpr(str, uint32_t(len), 0);
+}
+
+template <typename T>
+uint64_t create_hash(const T& key)
+{
+    return murmur_hash_64(&key, sizeof(T), 0);
+}
 } // namespace inferno
\ No newline at end of file
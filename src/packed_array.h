@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <climits>
 #include <stdio.h>
+#include <utility>
 
 typedef unsigned ID;
 
@@ -18,35 +19,41 @@ struct Index
     unsigned short next;
 };
 
+// Objects are kept densely packed in _objects and addressed through stable IDs. The lower 16 bits of an ID select an entry in
+// _indices, the upper bits count how often that entry has been reused so stale IDs can be detected. Entries are initialized
+// lazily the first time they are handed out, so construction and clear() don't touch all N of them.
 template <class T, size_t N>
 struct PackedArray
 {
     unsigned       _num_objects;
     T              _objects[N];
     Index          _indices[N];
+    ID             _object_ids[N];        // ID of the object at each packed position, used to patch its index when it moves.
+    unsigned       _num_initialized;      // Entries at or above this haven't been handed out since construction or the last clear().
+    unsigned       _num_ever_initialized; // Entries below this hold a valid generation from an earlier use.
+    unsigned       _num_free;             // Length of the freelist of removed entries.
     unsigned short _freelist_enqueue;
     unsigned short _freelist_dequeue;
 
     PackedArray()
     {
-        _num_objects = 0;
-        for (unsigned i = 0; i < N; ++i)
-        {
-            _indices[i].id   = i;
-            _indices[i].next = i + 1;
-        }
-        _freelist_dequeue = 0;
-        _freelist_enqueue = N - 1;
+        _num_objects          = 0;
+        _num_initialized      = 0;
+        _num_ever_initialized = 0;
+        _num_free             = 0;
+        _freelist_dequeue     = 0;
+        _freelist_enqueue     = 0;
     }
 
     ~PackedArray()
     {
-        for (unsigned i = 0; i < _num_objects; ++i)
-            _objects[i].~T();
     }
 
     inline bool has(ID id)
     {
+        if ((id & INDEX_MASK) >= _num_initialized)
+            return false;
+
         Index& in = _indices[id & INDEX_MASK];
         return in.id == id && in.index != USHRT_MAX;
     }
@@ -69,10 +76,34 @@ struct PackedArray
 
     inline ID add()
     {
-        Index& in         = _indices[_freelist_dequeue];
-        _freelist_dequeue = in.next;
+        unsigned short slot;
+
+        // Untouched entries are handed out first, then the ones freed by remove() in the order they were freed. This is the
+        // same order as a freelist pre-filled with every entry, so IDs are reused as late as possible.
+        if (_num_initialized < N)
+        {
+            slot = _num_initialized++;
+
+            // Entries reused after clear() keep counting up their generation, so IDs from before the clear stay invalid.
+            if (slot >= _num_ever_initialized)
+            {
+                _indices[slot].id     = slot;
+                _num_ever_initialized = slot + 1;
+            }
+        }
+        else
+        {
+            slot              = _freelist_dequeue;
+            _freelist_dequeue = _indices[slot].next;
+            _num_free--;
+        }
+
+        Index& in = _indices[slot];
         in.id += NEW_OBJECT_ID_ADD;
-        in.index = _num_objects++;
+        in.index              = _num_objects;
+        _object_ids[in.index] = in.id;
+        _num_objects++;
+
         return in.id;
     }
 
@@ -93,16 +124,37 @@ struct PackedArray
 
     inline void remove(ID id)
     {
-        Index& in = _indices[id & INDEX_MASK];
+        unsigned short slot = id & INDEX_MASK;
+        Index&         in   = _indices[slot];
+        unsigned       last = --_num_objects;
+
+        // Move the last object into the hole and point its entry at the new position.
+        if (in.index != last)
+        {
+            _objects[in.index]                             = std::move(_objects[last]);
+            _object_ids[in.index]                          = _object_ids[last];
+            _indices[_object_ids[last] & INDEX_MASK].index = in.index;
+        }
 
-        T& o = _objects[in.index];
-        o.~T();
-        o = _objects[--_num_objects];
+        // Reset the vacated slot so resources held by the removed object are released now rather than when the slot is reused.
+        _objects[last] = T();
 
-        _indices[id & INDEX_MASK].index = in.index;
+        in.index = USHRT_MAX;
 
-        in.index                         = USHRT_MAX;
-        _indices[_freelist_enqueue].next = id & INDEX_MASK;
-        _freelist_enqueue                = id & INDEX_MASK;
+        if (_num_free == 0)
+            _freelist_dequeue = slot;
+        else
+            _indices[_freelist_enqueue].next = slot;
+
+        _freelist_enqueue = slot;
+        _num_free++;
+    }
+
+    // Invalidates all IDs in constant time. The objects themselves are left as they are and get overwritten as new ones are added.
+    inline void clear()
+    {
+        _num_objects     = 0;
+        _num_initialized = 0;
+        _num_free        = 0;
     }
 };
@@ -0,0 +1,161 @@
+#include "pipeline_compiler.h"
+#include "logger.h"
+#include "macros.h"
+#include <algorithm>
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineCompiler::Ptr PipelineCompiler::create(Backend::Ptr backend, uint32_t thread_count)
+{
+    return std::shared_ptr<PipelineCompiler>(new PipelineCompiler(backend, thread_count));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineCompiler::PipelineCompiler(Backend::Ptr backend, uint32_t thread_count) :
+    Object(backend)
+{
+    if (thread_count == 0)
+        thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    m_threads.reserve(thread_count);
+
+    for (uint32_t i = 0; i < thread_count; i++)
+        m_threads.push_back(std::thread(&PipelineCompiler::worker, this));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineCompiler::~PipelineCompiler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+
+    m_work_cv.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+
+    // Anything still queued is never compiled.
+    for (auto& pipeline : m_queue)
+        pipeline->m_state.store(AsyncPipelineBase::STATE_FAILED, std::memory_order_release);
+
+    m_done_cv.notify_all();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+AsyncGraphicsPipeline::Ptr PipelineCompiler::compile(const GraphicsPipeline::Desc& desc)
+{
+    AsyncGraphicsPipeline::Ptr pipeline;
+    compile(&desc, 1, &pipeline);
+
+    return pipeline;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+AsyncComputePipeline::Ptr PipelineCompiler::compile(const ComputePipeline::Desc& desc)
+{
+    AsyncComputePipeline::Ptr pipeline;
+    compile(&desc, 1, &pipeline);
+
+    return pipeline;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void PipelineCompiler::compile(const GraphicsPipeline::Desc* descs, uint32_t count, AsyncGraphicsPipeline::Ptr* out)
+{
+    for (uint32_t i = 0; i < count; i++)
+        out[i] = std::make_shared<AsyncGraphicsPipeline>(descs[i]);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (uint32_t i = 0; i < count; i++)
+            m_queue.push_back(out[i]);
+    }
+
+    m_work_cv.notify_all();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void PipelineCompiler::compile(const ComputePipeline::Desc* descs, uint32_t count, AsyncComputePipeline::Ptr* out)
+{
+    for (uint32_t i = 0; i < count; i++)
+        out[i] = std::make_shared<AsyncComputePipeline>(descs[i]);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (uint32_t i = 0; i < count; i++)
+            m_queue.push_back(out[i]);
+    }
+
+    m_work_cv.notify_all();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void PipelineCompiler::wait(AsyncPipelineBase* pipeline)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [&]() { return pipeline->is_ready(); });
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void PipelineCompiler::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [&]() { return m_queue.empty() && m_in_progress == 0; });
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void PipelineCompiler::worker()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_work_cv.wait(lock, [&]() { return m_quit || !m_queue.empty(); });
+
+        if (m_quit)
+            return;
+
+        std::shared_ptr<AsyncPipelineBase> pipeline = m_queue.front();
+        m_queue.pop_front();
+        m_in_progress++;
+
+        lock.unlock();
+
+        if (auto backend = m_vk_backend.lock())
+            pipeline->compile(backend);
+        else
+            pipeline->m_state.store(AsyncPipelineBase::STATE_FAILED, std::memory_order_release);
+
+        if (pipeline->failed())
+            INFERNO_LOG_ERROR("(Vulkan) Failed to compile pipeline asynchronously.");
+
+        // Released outside of the lock in case this was the last reference.
+        pipeline.reset();
+
+        lock.lock();
+        m_in_progress--;
+
+        m_done_cv.notify_all();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "vk.h"
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace inferno
+{
+namespace vk
+{
+class PipelineCompiler;
+
+class AsyncPipelineBase
+{
+public:
+    virtual ~AsyncPipelineBase() {}
+
+    inline bool is_ready() { return m_state.load(std::memory_order_acquire) != STATE_PENDING; }
+    inline bool failed() { return m_state.load(std::memory_order_acquire) == STATE_FAILED; }
+
+protected:
+    friend class PipelineCompiler;
+
+    enum State
+    {
+        STATE_PENDING = 0,
+        STATE_READY,
+        STATE_FAILED
+    };
+
+    virtual void compile(Backend::Ptr backend) = 0;
+
+protected:
+    std::atomic<uint32_t> m_state { STATE_PENDING };
+};
+
+// A pipeline that is being compiled by a PipelineCompiler. get() never blocks, so draws using a pipeline that isn't ready yet can
+// either be skipped or use a fallback.
+template <typename T>
+class AsyncPipeline : public AsyncPipelineBase
+{
+public:
+    using Ptr = std::shared_ptr<AsyncPipeline<T>>;
+
+    AsyncPipeline(const typename T::Desc& desc) :
+        m_desc(desc) {}
+
+    // Returns the compiled pipeline, or 'fallback' while it is still pending or if compilation failed.
+    inline T* get(T* fallback = nullptr) { return m_state.load(std::memory_order_acquire) == STATE_READY ? m_pipeline.get() : fallback; }
+
+    // Only valid once is_ready() returned true.
+    inline typename T::Ptr pipeline() { return m_pipeline; }
+
+private:
+    void compile(Backend::Ptr backend) override
+    {
+        try
+        {
+            m_pipeline = T::create(backend, m_desc);
+            m_state.store(STATE_READY, std::memory_order_release);
+        }
+        catch (std::exception&)
+        {
+            m_state.store(STATE_FAILED, std::memory_order_release);
+        }
+    }
+
+private:
+    typename T::Desc m_desc;
+    typename T::Ptr  m_pipeline;
+};
+
+using AsyncGraphicsPipeline = AsyncPipeline<GraphicsPipeline>;
+using AsyncComputePipeline  = AsyncPipeline<ComputePipeline>;
+
+// Compiles batches of pipelines on a set of worker threads, all sharing the Backend's pipeline cache. Descs are copied on
+// submission, but the shader modules, layouts and render passes they reference must stay alive until the pipeline is ready.
+//
+//     compiler->compile(&descs[0], count, &pipelines[0]);
+//     ...
+//     if (GraphicsPipeline* pipeline = pipelines[i]->get())
+//         vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle());
+//
+// Submission and get() are thread-safe.
+class PipelineCompiler : public Object
+{
+public:
+    using Ptr = std::shared_ptr<PipelineCompiler>;
+
+    // A 'thread_count' of 0 uses one thread per hardware thread except for the calling one.
+    static PipelineCompiler::Ptr create(Backend::Ptr backend, uint32_t thread_count = 0);
+
+    ~PipelineCompiler();
+
+    AsyncGraphicsPipeline::Ptr compile(const GraphicsPipeline::Desc& desc);
+    AsyncComputePipeline::Ptr  compile(const ComputePipeline::Desc& desc);
+
+    // Queues 'count' pipelines at once and writes their handles to 'out'.
+    void compile(const GraphicsPipeline::Desc* descs, uint32_t count, AsyncGraphicsPipeline::Ptr* out);
+    void compile(const ComputePipeline::Desc* descs, uint32_t count, AsyncComputePipeline::Ptr* out);
+
+    // Blocks until 'pipeline' is ready or failed.
+    void wait(AsyncPipelineBase* pipeline);
+
+    // Blocks until every queued pipeline is ready or failed, e.g. at the end of a loading screen.
+    void wait_idle();
+
+    inline uint32_t thread_count() { return uint32_t(m_threads.size()); }
+
+private:
+    PipelineCompiler(Backend::Ptr backend, uint32_t thread_count);
+    void worker();
+
+private:
+    std::vector<std::thread>                       m_threads;
+    std::deque<std::shared_ptr<AsyncPipelineBase>> m_queue;
+    std::mutex                                     m_mutex;
+    std::condition_variable                        m_work_cv;
+    std::condition_variable                        m_done_cv;
+    uint32_t                                       m_in_progress = 0;
+    bool                                           m_quit        = false;
+};
+} // namespace vk
+} // namespace inferno
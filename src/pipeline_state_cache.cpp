@@ -0,0 +1,264 @@
+#include "pipeline_state_cache.h"
+#include "fast_hash.h"
+#include "logger.h"
+#include "macros.h"
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void add_stencil_op_state(FieldHasher& h, const VkStencilOpState& state)
+{
+    h.add(state.failOp).add(state.passOp).add(state.depthFailOp).add(state.compareOp);
+    h.add(state.compareMask).add(state.writeMask).add(state.reference);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineKey pipeline_key(const GraphicsPipeline::Desc& desc)
+{
+    const VkGraphicsPipelineCreateInfo& info = desc.create_info;
+
+    FieldHasher program;
+
+    program.add(desc.shader_stage_count);
+
+    for (uint32_t i = 0; i < desc.shader_stage_count; i++)
+    {
+        program.add(desc.shader_stages[i].stage).add(desc.shader_hashes[i]);
+        program.add(uint32_t(desc.shader_entry_names[i].size())).add_bytes(desc.shader_entry_names[i].c_str(), desc.shader_entry_names[i].size());
+    }
+
+    program.add(info.layout).add(desc.render_pass_hash).add(info.subpass);
+
+    // Every state block only counts if the Desc actually sets it.
+    FieldHasher state;
+
+    state.add(info.flags);
+    state.add(info.pVertexInputState != nullptr);
+
+    if (info.pVertexInputState)
+    {
+        const VertexInputStateDesc& vi = desc.vertex_input_state;
+
+        state.add(vi.create_info.vertexBindingDescriptionCount).add(vi.create_info.vertexAttributeDescriptionCount);
+
+        for (uint32_t i = 0; i < vi.create_info.vertexBindingDescriptionCount; i++)
+            state.add(vi.binding_desc[i].binding).add(vi.binding_desc[i].stride).add(vi.binding_desc[i].inputRate);
+
+        for (uint32_t i = 0; i < vi.create_info.vertexAttributeDescriptionCount; i++)
+            state.add(vi.attribute_desc[i].location).add(vi.attribute_desc[i].binding).add(vi.attribute_desc[i].format).add(vi.attribute_desc[i].offset);
+    }
+
+    state.add(info.pInputAssemblyState != nullptr);
+
+    if (info.pInputAssemblyState)
+    {
+        const VkPipelineInputAssemblyStateCreateInfo& ia = desc.input_assembly_state.create_info;
+        state.add(ia.flags).add(ia.topology).add(ia.primitiveRestartEnable);
+    }
+
+    state.add(info.pTessellationState != nullptr);
+
+    if (info.pTessellationState)
+    {
+        const VkPipelineTessellationStateCreateInfo& ts = desc.tessellation_state.create_info;
+        state.add(ts.flags).add(ts.patchControlPoints);
+    }
+
+    state.add(info.pRasterizationState != nullptr);
+
+    if (info.pRasterizationState)
+    {
+        const VkPipelineRasterizationStateCreateInfo& rs = desc.rasterization_state.create_info;
+
+        state.add(rs.flags).add(rs.depthClampEnable).add(rs.rasterizerDiscardEnable).add(rs.polygonMode).add(rs.cullMode).add(rs.frontFace);
+        state.add(rs.depthBiasEnable).add(rs.depthBiasConstantFactor).add(rs.depthBiasClamp).add(rs.depthBiasSlopeFactor).add(rs.lineWidth);
+        state.add(rs.pNext != nullptr);
+
+        if (rs.pNext)
+        {
+            const VkPipelineRasterizationConservativeStateCreateInfoEXT& cr = desc.rasterization_state.conservative_raster_create_info;
+            state.add(cr.flags).add(cr.conservativeRasterizationMode).add(cr.extraPrimitiveOverestimationSize);
+        }
+    }
+
+    state.add(info.pMultisampleState != nullptr);
+
+    if (info.pMultisampleState)
+    {
+        const VkPipelineMultisampleStateCreateInfo& ms = desc.multisample_state.create_info;
+
+        state.add(ms.flags).add(ms.rasterizationSamples).add(ms.sampleShadingEnable).add(ms.minSampleShading);
+        state.add(ms.alphaToCoverageEnable).add(ms.alphaToOneEnable);
+        state.add(ms.pSampleMask != nullptr);
+
+        if (ms.pSampleMask)
+        {
+            for (uint32_t i = 0; i < (uint32_t(ms.rasterizationSamples) + 31) / 32; i++)
+                state.add(ms.pSampleMask[i]);
+        }
+    }
+
+    state.add(info.pDepthStencilState != nullptr);
+
+    if (info.pDepthStencilState)
+    {
+        const VkPipelineDepthStencilStateCreateInfo& ds = desc.depth_stencil_state.create_info;
+
+        state.add(ds.flags).add(ds.depthTestEnable).add(ds.depthWriteEnable).add(ds.depthCompareOp).add(ds.depthBoundsTestEnable);
+        state.add(ds.stencilTestEnable).add(ds.minDepthBounds).add(ds.maxDepthBounds);
+
+        add_stencil_op_state(state, ds.front);
+        add_stencil_op_state(state, ds.back);
+    }
+
+    state.add(info.pColorBlendState != nullptr);
+
+    if (info.pColorBlendState)
+    {
+        const VkPipelineColorBlendStateCreateInfo& cb = desc.color_blend_state.create_info;
+
+        state.add(cb.flags).add(cb.logicOpEnable).add(cb.logicOp).add(cb.attachmentCount);
+        state.add(cb.blendConstants[0]).add(cb.blendConstants[1]).add(cb.blendConstants[2]).add(cb.blendConstants[3]);
+
+        for (uint32_t i = 0; i < cb.attachmentCount; i++)
+        {
+            const VkPipelineColorBlendAttachmentState& att = desc.color_blend_state.attachments[i];
+
+            state.add(att.blendEnable).add(att.srcColorBlendFactor).add(att.dstColorBlendFactor).add(att.colorBlendOp);
+            state.add(att.srcAlphaBlendFactor).add(att.dstAlphaBlendFactor).add(att.alphaBlendOp).add(att.colorWriteMask);
+        }
+    }
+
+    state.add(info.basePipelineHandle);
+
+    PipelineKey key;
+
+    key.program_hash = program.result();
+    key.state_hash   = state.result();
+
+    return key;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineKey pipeline_key(const ComputePipeline::Desc& desc)
+{
+    const VkComputePipelineCreateInfo& info = desc.create_info;
+
+    FieldHasher program;
+
+    program.add(desc.shader_hash).add(uint32_t(desc.shader_entry_name.size())).add_bytes(desc.shader_entry_name.c_str(), desc.shader_entry_name.size());
+    program.add(info.layout);
+
+    FieldHasher state;
+
+    state.add(info.flags).add(info.basePipelineHandle);
+
+    PipelineKey key;
+
+    key.program_hash = program.result();
+    key.state_hash   = state.result();
+
+    return key;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineStateCache::Ptr PipelineStateCache::create(Backend::Ptr backend)
+{
+    return std::shared_ptr<PipelineStateCache>(new PipelineStateCache(backend));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineStateCache::PipelineStateCache(Backend::Ptr backend) :
+    Object(backend)
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineStateCache::~PipelineStateCache()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+GraphicsPipeline::Ptr PipelineStateCache::get(const GraphicsPipeline::Desc& desc)
+{
+    PipelineKey key = pipeline_key(desc);
+
+    return m_graphics_pipelines.get_or_create(key, [&]() {
+        auto                   backend = m_vk_backend.lock();
+        GraphicsPipeline::Desc variant = desc;
+        GraphicsPipeline::Ptr  base;
+
+        variant.create_info.flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
+
+        if (!variant.create_info.basePipelineHandle && m_graphics_bases.get(key.program_hash, base))
+        {
+            variant.create_info.flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+            variant.create_info.basePipelineHandle = base->handle();
+            variant.create_info.basePipelineIndex  = -1;
+        }
+
+        GraphicsPipeline::Ptr pipeline = GraphicsPipeline::create(backend, variant);
+
+        if (!base)
+            m_graphics_bases.insert(key.program_hash, pipeline);
+
+        return pipeline;
+    });
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+ComputePipeline::Ptr PipelineStateCache::get(const ComputePipeline::Desc& desc)
+{
+    PipelineKey key = pipeline_key(desc);
+
+    return m_compute_pipelines.get_or_create(key, [&]() {
+        auto                  backend = m_vk_backend.lock();
+        ComputePipeline::Desc variant = desc;
+        ComputePipeline::Ptr  base;
+
+        variant.create_info.flags |= VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
+
+        if (!variant.create_info.basePipelineHandle && m_compute_bases.get(key.program_hash, base))
+        {
+            variant.create_info.flags |= VK_PIPELINE_CREATE_DERIVATIVE_BIT;
+            variant.create_info.basePipelineHandle = base->handle();
+            variant.create_info.basePipelineIndex  = -1;
+        }
+
+        ComputePipeline::Ptr pipeline = ComputePipeline::create(backend, variant);
+
+        if (!base)
+            m_compute_bases.insert(key.program_hash, pipeline);
+
+        return pipeline;
+    });
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void PipelineStateCache::clear()
+{
+    m_graphics_bases.clear();
+    m_compute_bases.clear();
+    m_graphics_pipelines.clear();
+    m_compute_pipelines.clear();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "vk.h"
+#include "concurrent_hash_map.h"
+#include <stdint.h>
+
+namespace inferno
+{
+namespace vk
+{
+// Canonical, pointer-free identity of a pipeline Desc. 'program_hash' covers the shaders, entry points, pipeline layout and render
+// pass compatibility, 'state_hash' covers the fixed-function state. Pipelines sharing a program only differ in state, which makes
+// them good candidates for pipeline derivatives.
+struct PipelineKey
+{
+    uint64_t program_hash;
+    uint64_t state_hash;
+
+    bool operator==(const PipelineKey& other) const
+    {
+        return program_hash == other.program_hash && state_hash == other.state_hash;
+    }
+};
+
+extern PipelineKey pipeline_key(const GraphicsPipeline::Desc& desc);
+extern PipelineKey pipeline_key(const ComputePipeline::Desc& desc);
+
+// Returns an existing pipeline for every Desc that is equivalent to one seen before instead of creating a duplicate VkPipeline.
+// The first pipeline created for a program becomes the base pipeline of every later variant of it, unless the Desc already names
+// a base pipeline. Pipeline layouts are identified by their handle, so equivalent layouts should themselves be shared.
+//
+// Lookups are lock-free and creation is safe to call from multiple threads, e.g. from PipelineCompiler workers.
+class PipelineStateCache : public Object
+{
+public:
+    using Ptr = std::shared_ptr<PipelineStateCache>;
+
+    static PipelineStateCache::Ptr create(Backend::Ptr backend);
+
+    ~PipelineStateCache();
+
+    GraphicsPipeline::Ptr get(const GraphicsPipeline::Desc& desc);
+    ComputePipeline::Ptr  get(const ComputePipeline::Desc& desc);
+
+    // Destroys every cached pipeline. Must not run concurrently with get().
+    void clear();
+
+    inline uint32_t graphics_pipeline_count() { return m_graphics_pipelines.size(); }
+    inline uint32_t compute_pipeline_count() { return m_compute_pipelines.size(); }
+
+private:
+    PipelineStateCache(Backend::Ptr backend);
+
+private:
+    ConcurrentHashMap<PipelineKey, GraphicsPipeline::Ptr> m_graphics_pipelines;
+    ConcurrentHashMap<PipelineKey, ComputePipeline::Ptr>  m_compute_pipelines;
+    ConcurrentHashMap<uint64_t, GraphicsPipeline::Ptr>    m_graphics_bases;
+    ConcurrentHashMap<uint64_t, ComputePipeline::Ptr>     m_compute_bases;
+};
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,605 @@
+#include "pvs.h"
+#include "entity.h"
+#include "packed_array.h"
+#include "logger.h"
+#include <algorithm>
+#include <fstream>
+#include <float.h>
+#include <string.h>
+#include <cmath>
+
+#define PVS_MAGIC 0x31535650 // "PVS1"
+#define PVS_MAX_CELLS (1 << 24)
+#define PVS_BVH_LEAF_SIZE 4
+
+namespace inferno
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct Occluder
+{
+    OBB      obb;
+    AABB     aabb;
+    uint32_t slot;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct BVHNode
+{
+    AABB     aabb;
+    uint32_t first; // Left child for interior nodes, first occluder index for leaves.
+    uint32_t right; // Right child for interior nodes.
+    uint32_t count; // Number of occluders. Zero for interior nodes.
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct BVH
+{
+    std::vector<BVHNode>  nodes;
+    std::vector<uint32_t> indices;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t xorshift(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static float random_float(uint32_t& state)
+{
+    return float(xorshift(state) & 0xffffff) / float(0xffffff);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static glm::vec3 random_point(uint32_t& state, const glm::vec3& min, const glm::vec3& max)
+{
+    return glm::vec3(min.x + (max.x - min.x) * random_float(state),
+                     min.y + (max.y - min.y) * random_float(state),
+                     min.z + (max.z - min.z) * random_float(state));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static glm::vec3 to_obb_local(const OBB& obb, const glm::vec3& p)
+{
+    return glm::transpose(obb.orientation) * (p - obb.position) + (obb.max + obb.min) * 0.5f;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static bool inside_obb(const OBB& obb, const glm::vec3& p)
+{
+    glm::vec3 local = to_obb_local(obb, p);
+
+    return local.x > obb.min.x && local.y > obb.min.y && local.z > obb.min.z && local.x < obb.max.x && local.y < obb.max.y && local.z < obb.max.z;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static bool overlaps(const AABB& a, const AABB& b)
+{
+    return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t build_bvh(BVH& bvh, const std::vector<Occluder>& occluders, uint32_t first, uint32_t count)
+{
+    uint32_t node_index = uint32_t(bvh.nodes.size());
+    bvh.nodes.push_back(BVHNode());
+
+    AABB bounds   = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+    AABB centroid = { glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+
+    for (uint32_t i = first; i < first + count; i++)
+    {
+        const AABB& aabb = occluders[bvh.indices[i]].aabb;
+        glm::vec3   c    = (aabb.min + aabb.max) * 0.5f;
+
+        bounds.min   = glm::min(bounds.min, aabb.min);
+        bounds.max   = glm::max(bounds.max, aabb.max);
+        centroid.min = glm::min(centroid.min, c);
+        centroid.max = glm::max(centroid.max, c);
+    }
+
+    bvh.nodes[node_index].aabb = bounds;
+
+    if (count <= PVS_BVH_LEAF_SIZE)
+    {
+        bvh.nodes[node_index].first = first;
+        bvh.nodes[node_index].right = 0;
+        bvh.nodes[node_index].count = count;
+        return node_index;
+    }
+
+    // Median split along the longest centroid axis.
+    glm::vec3 extent = centroid.max - centroid.min;
+    int       axis   = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+    uint32_t  half   = count / 2;
+
+    std::nth_element(bvh.indices.begin() + first, bvh.indices.begin() + first + half, bvh.indices.begin() + first + count, [&](uint32_t a, uint32_t b) {
+        return (occluders[a].aabb.min[axis] + occluders[a].aabb.max[axis]) < (occluders[b].aabb.min[axis] + occluders[b].aabb.max[axis]);
+    });
+
+    uint32_t left  = build_bvh(bvh, occluders, first, half);
+    uint32_t right = build_bvh(bvh, occluders, first + half, count - half);
+
+    bvh.nodes[node_index].first = left;
+    bvh.nodes[node_index].right = right;
+    bvh.nodes[node_index].count = 0;
+
+    return node_index;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Returns true if anything other than 'target_slot' blocks the segment between 'origin' and 'origin + dir * t_max'.
+static bool occluded(const BVH& bvh, const std::vector<Occluder>& occluders, const Ray& ray, float t_max, uint32_t target_slot)
+{
+    uint32_t stack[64];
+    uint32_t stack_size = 0;
+
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        const BVHNode& node = bvh.nodes[stack[--stack_size]];
+
+        float t_enter, t_exit;
+
+        if (!intersects(ray, node.aabb, t_enter, t_exit) || t_enter > t_max)
+            continue;
+
+        if (node.count == 0)
+        {
+            stack[stack_size++] = node.first;
+            stack[stack_size++] = node.right;
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            const Occluder& occluder = occluders[bvh.indices[i]];
+
+            if (occluder.slot == target_slot)
+                continue;
+
+            // Trace in the box's local space. The transform is linear, so hit distances carry over unchanged.
+            Ray local_ray(to_obb_local(occluder.obb, ray.origin), glm::transpose(occluder.obb.orientation) * ray.direction);
+            AABB local_box = { occluder.obb.min, occluder.obb.max };
+
+            // Boxes that contain the origin are ignored, the sample point just happens to lie in them.
+            if (intersects(local_ray, local_box, t_enter, t_exit) && t_enter > 0.0f && t_enter < t_max)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Zero-run-length encoding: non-zero bytes are stored as is, runs of zero bytes as a zero followed by the run length.
+static void compress(const uint64_t* bits, std::vector<uint8_t>& out)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(bits);
+    const uint32_t size  = PVS_ENTITY_WORDS * sizeof(uint64_t);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (bytes[i] != 0)
+        {
+            out.push_back(bytes[i]);
+            continue;
+        }
+
+        uint32_t run = 1;
+
+        while (i + run < size && bytes[i + run] == 0 && run < 255)
+            run++;
+
+        out.push_back(0);
+        out.push_back(uint8_t(run));
+
+        i += run - 1;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bake_pvs(PVS& pvs, Entity* entities, uint32_t entity_count, const PVSBakeSettings& settings)
+{
+    std::vector<Occluder> occluders;
+
+    for (uint32_t i = 0; i < entity_count; i++)
+    {
+        Entity& e = entities[i];
+
+        if (!e.is_static || (e.id & INDEX_MASK) >= MAX_ENTITIES)
+            continue;
+
+        Occluder occluder;
+
+        occluder.obb  = e.obb;
+        occluder.aabb = aabb_from_obb(e.obb);
+        occluder.slot = e.id & INDEX_MASK;
+
+        occluders.push_back(occluder);
+    }
+
+    pvs.cell_offsets.clear();
+    pvs.data.clear();
+    pvs.cell_size = settings.cell_size;
+
+    if (occluders.empty())
+    {
+        pvs.dims[0] = pvs.dims[1] = pvs.dims[2] = 0;
+        return;
+    }
+
+    BVH bvh;
+
+    bvh.indices.resize(occluders.size());
+
+    for (uint32_t i = 0; i < occluders.size(); i++)
+        bvh.indices[i] = i;
+
+    build_bvh(bvh, occluders, 0, uint32_t(occluders.size()));
+
+    pvs.bounds = bvh.nodes[0].aabb;
+
+    glm::vec3 extent = pvs.bounds.max - pvs.bounds.min;
+
+    for (int i = 0; i < 3; i++)
+        pvs.dims[i] = std::max(1u, uint32_t(ceilf(extent[i] / settings.cell_size)));
+
+    uint32_t cell_count = pvs.dims[0] * pvs.dims[1] * pvs.dims[2];
+
+    if (cell_count > PVS_MAX_CELLS)
+    {
+        INFERNO_LOG_ERROR("(PVS) Too many cells (" + std::to_string(cell_count) + "). Increase the cell size.");
+        pvs.dims[0] = pvs.dims[1] = pvs.dims[2] = 0;
+        return;
+    }
+
+    std::vector<uint64_t> raw(size_t(cell_count) * PVS_ENTITY_WORDS, 0);
+    std::vector<bool>     solid(cell_count, false);
+    uint32_t              rng = settings.seed ? settings.seed : 1;
+
+    INFERNO_LOG_INFO("(PVS) Baking " + std::to_string(cell_count) + " cells against " + std::to_string(occluders.size()) + " static entities.");
+
+    for (uint32_t z = 0; z < pvs.dims[2]; z++)
+    {
+        for (uint32_t y = 0; y < pvs.dims[1]; y++)
+        {
+            for (uint32_t x = 0; x < pvs.dims[0]; x++)
+            {
+                uint32_t cell = x + pvs.dims[0] * (y + pvs.dims[1] * z);
+                AABB     box;
+
+                box.min = pvs.bounds.min + glm::vec3(float(x), float(y), float(z)) * settings.cell_size;
+                box.max = box.min + glm::vec3(settings.cell_size);
+
+                glm::vec3 center = (box.min + box.max) * 0.5f;
+
+                // Cells whose center is buried in geometry aren't navigable.
+                for (const auto& occluder : occluders)
+                {
+                    if (inside_obb(occluder.obb, center))
+                    {
+                        solid[cell] = true;
+                        break;
+                    }
+                }
+
+                if (solid[cell])
+                    continue;
+
+                uint64_t* bits = &raw[size_t(cell) * PVS_ENTITY_WORDS];
+
+                for (const auto& target : occluders)
+                {
+                    bool visible = overlaps(box, target.aabb);
+
+                    for (uint32_t s = 0; s < settings.samples && !visible; s++)
+                    {
+                        glm::vec3 from     = random_point(rng, box.min, box.max);
+                        glm::vec3 local    = random_point(rng, target.obb.min, target.obb.max);
+                        glm::vec3 to       = target.obb.position + target.obb.orientation * (local - (target.obb.min + target.obb.max) * 0.5f);
+                        glm::vec3 dir      = to - from;
+                        float     distance = glm::length(dir);
+
+                        if (distance < 1e-4f)
+                        {
+                            visible = true;
+                            break;
+                        }
+
+                        visible = !occluded(bvh, occluders, Ray(from, dir / distance), distance, target.slot);
+                    }
+
+                    if (visible)
+                        SET_BIT_64(bits[target.slot / 64], target.slot % 64);
+                }
+            }
+        }
+    }
+
+    // Dilate into neighbouring navigable cells to cover for sample rays that missed a narrow opening.
+    for (uint32_t pass = 0; pass < settings.dilation; pass++)
+    {
+        std::vector<uint64_t> dilated = raw;
+
+        for (uint32_t z = 0; z < pvs.dims[2]; z++)
+        {
+            for (uint32_t y = 0; y < pvs.dims[1]; y++)
+            {
+                for (uint32_t x = 0; x < pvs.dims[0]; x++)
+                {
+                    uint32_t cell = x + pvs.dims[0] * (y + pvs.dims[1] * z);
+
+                    if (solid[cell])
+                        continue;
+
+                    for (int dz = -1; dz <= 1; dz++)
+                    {
+                        for (int dy = -1; dy <= 1; dy++)
+                        {
+                            for (int dx = -1; dx <= 1; dx++)
+                            {
+                                int nx = int(x) + dx;
+                                int ny = int(y) + dy;
+                                int nz = int(z) + dz;
+
+                                if (nx < 0 || ny < 0 || nz < 0 || nx >= int(pvs.dims[0]) || ny >= int(pvs.dims[1]) || nz >= int(pvs.dims[2]))
+                                    continue;
+
+                                uint32_t neighbour = uint32_t(nx) + pvs.dims[0] * (uint32_t(ny) + pvs.dims[1] * uint32_t(nz));
+
+                                if (solid[neighbour])
+                                    continue;
+
+                                for (uint32_t w = 0; w < PVS_ENTITY_WORDS; w++)
+                                    dilated[size_t(cell) * PVS_ENTITY_WORDS + w] |= raw[size_t(neighbour) * PVS_ENTITY_WORDS + w];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        raw.swap(dilated);
+    }
+
+    pvs.cell_offsets.resize(cell_count);
+
+    for (uint32_t cell = 0; cell < cell_count; cell++)
+    {
+        if (solid[cell])
+        {
+            pvs.cell_offsets[cell] = PVS_INVALID_CELL;
+            continue;
+        }
+
+        pvs.cell_offsets[cell] = uint32_t(pvs.data.size());
+        compress(&raw[size_t(cell) * PVS_ENTITY_WORDS], pvs.data);
+    }
+
+    INFERNO_LOG_INFO("(PVS) Compressed " + std::to_string(raw.size() * sizeof(uint64_t)) + " bytes to " + std::to_string(pvs.data.size()) + " bytes.");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool save_pvs(const PVS& pvs, const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        INFERNO_LOG_ERROR("(PVS) Failed to open file for writing: " + path);
+        return false;
+    }
+
+    uint32_t magic       = PVS_MAGIC;
+    uint32_t entity_bits = MAX_ENTITIES;
+    uint32_t cell_count  = uint32_t(pvs.cell_offsets.size());
+    uint32_t data_size   = uint32_t(pvs.data.size());
+
+    file.write((const char*)&magic, sizeof(magic));
+    file.write((const char*)&entity_bits, sizeof(entity_bits));
+    file.write((const char*)&pvs.bounds, sizeof(pvs.bounds));
+    file.write((const char*)&pvs.cell_size, sizeof(pvs.cell_size));
+    file.write((const char*)&pvs.dims[0], sizeof(pvs.dims));
+    file.write((const char*)&cell_count, sizeof(cell_count));
+    file.write((const char*)&data_size, sizeof(data_size));
+    file.write((const char*)pvs.cell_offsets.data(), cell_count * sizeof(uint32_t));
+    file.write((const char*)pvs.data.data(), data_size);
+
+    return file.good();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool load_pvs(PVS& pvs, const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open())
+    {
+        INFERNO_LOG_ERROR("(PVS) Failed to open file: " + path);
+        return false;
+    }
+
+    uint32_t magic       = 0;
+    uint32_t entity_bits = 0;
+    uint32_t cell_count  = 0;
+    uint32_t data_size   = 0;
+
+    file.read((char*)&magic, sizeof(magic));
+    file.read((char*)&entity_bits, sizeof(entity_bits));
+
+    if (magic != PVS_MAGIC || entity_bits != MAX_ENTITIES)
+    {
+        INFERNO_LOG_ERROR("(PVS) Invalid or outdated file: " + path);
+        return false;
+    }
+
+    file.read((char*)&pvs.bounds, sizeof(pvs.bounds));
+    file.read((char*)&pvs.cell_size, sizeof(pvs.cell_size));
+    file.read((char*)&pvs.dims[0], sizeof(pvs.dims));
+    file.read((char*)&cell_count, sizeof(cell_count));
+    file.read((char*)&data_size, sizeof(data_size));
+
+    // Check the sizes against what is actually left in the file before allocating anything.
+    std::streampos header_end = file.tellg();
+    file.seekg(0, std::ios::end);
+    uint64_t remaining = uint64_t(file.tellg() - header_end);
+    file.seekg(header_end);
+
+    // pvs_cell() divides by the cell size, so it has to be a finite positive number.
+    if (!file.good() || !std::isfinite(pvs.cell_size) || pvs.cell_size <= 0.0f || uint64_t(cell_count) != uint64_t(pvs.dims[0]) * uint64_t(pvs.dims[1]) * uint64_t(pvs.dims[2]) || uint64_t(cell_count) * sizeof(uint32_t) + data_size > remaining)
+    {
+        INFERNO_LOG_ERROR("(PVS) Corrupt file: " + path);
+        pvs = PVS();
+        return false;
+    }
+
+    pvs.cell_offsets.resize(cell_count);
+    pvs.data.resize(data_size);
+
+    file.read((char*)pvs.cell_offsets.data(), size_t(cell_count) * sizeof(uint32_t));
+    file.read((char*)pvs.data.data(), data_size);
+
+    bool valid = file.good();
+
+    // Every set has to start inside the data. pvs_decompress() checks the rest while decoding.
+    for (uint32_t i = 0; valid && i < cell_count; i++)
+        valid = pvs.cell_offsets[i] == PVS_INVALID_CELL || pvs.cell_offsets[i] < data_size;
+
+    if (!valid)
+    {
+        INFERNO_LOG_ERROR("(PVS) Corrupt file: " + path);
+        pvs = PVS();
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t pvs_cell(const PVS& pvs, const glm::vec3& position)
+{
+    if (pvs.cell_offsets.empty())
+        return PVS_INVALID_CELL;
+
+    glm::vec3 p = (position - pvs.bounds.min) / pvs.cell_size;
+
+    // Range check before converting, since converting a float outside the uint32_t range is undefined. Written so that NaN fails.
+    if (!(p.x >= 0.0f && p.x < float(pvs.dims[0]) && p.y >= 0.0f && p.y < float(pvs.dims[1]) && p.z >= 0.0f && p.z < float(pvs.dims[2])))
+        return PVS_INVALID_CELL;
+
+    uint32_t x = uint32_t(p.x);
+    uint32_t y = uint32_t(p.y);
+    uint32_t z = uint32_t(p.z);
+
+    // float(dims) may have rounded up for very large grids.
+    if (x >= pvs.dims[0] || y >= pvs.dims[1] || z >= pvs.dims[2])
+        return PVS_INVALID_CELL;
+
+    uint32_t cell = x + pvs.dims[0] * (y + pvs.dims[1] * z);
+
+    return pvs.cell_offsets[cell] == PVS_INVALID_CELL ? PVS_INVALID_CELL : cell;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool pvs_decompress(const PVS& pvs, uint32_t cell, uint64_t* bits)
+{
+    uint8_t*       dst  = reinterpret_cast<uint8_t*>(bits);
+    const uint32_t size = PVS_ENTITY_WORDS * sizeof(uint64_t);
+    uint32_t       out  = 0;
+
+    if (cell >= pvs.cell_offsets.size() || pvs.cell_offsets[cell] >= pvs.data.size())
+        return false;
+
+    const uint8_t* src = &pvs.data[pvs.cell_offsets[cell]];
+    const uint8_t* end = pvs.data.data() + pvs.data.size();
+
+    while (out < size)
+    {
+        if (src == end)
+            return false;
+
+        if (*src != 0)
+            dst[out++] = *src++;
+        else
+        {
+            if (end - src < 2)
+                return false;
+
+            uint32_t run = src[1];
+
+            if (run == 0 || run > size - out)
+                return false;
+
+            memset(dst + out, 0, run);
+            out += run;
+            src += 2;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void apply_pvs(const PVS& pvs, PVSQuery& query, const glm::vec3& camera_position, Entity* entities, uint32_t entity_count, uint32_t view_index)
+{
+    uint32_t cell = pvs_cell(pvs, camera_position);
+
+    if (cell == PVS_INVALID_CELL)
+    {
+        query.cell = PVS_INVALID_CELL;
+
+        for (uint32_t i = 0; i < entity_count; i++)
+            entities[i].set_visible(view_index);
+
+        return;
+    }
+
+    if (cell != query.cell)
+    {
+        // A malformed set must not hide anything, so fall back to treating every entity as potentially visible.
+        if (!pvs_decompress(pvs, cell, &query.bits[0]))
+        {
+            INFERNO_LOG_ERROR("(PVS) Corrupt set for cell " + std::to_string(cell) + ".");
+            memset(&query.bits[0], 0xff, sizeof(query.bits));
+        }
+
+        query.cell = cell;
+    }
+
+    for (uint32_t i = 0; i < entity_count; i++)
+    {
+        Entity&  e    = entities[i];
+        uint32_t slot = e.id & INDEX_MASK;
+
+        if (!e.is_static || slot >= MAX_ENTITIES || (query.bits[slot / 64] & BIT_FLAG_64(slot % 64)))
+            e.set_visible(view_index);
+        else
+            e.set_invisible(view_index);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "geometry.h"
+#include "constants.h"
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+// Number of 64-bit words needed to hold one bit per entity slot.
+#define PVS_ENTITY_WORDS ((MAX_ENTITIES + 63) / 64)
+#define PVS_INVALID_CELL 0xffffffffu
+
+namespace inferno
+{
+struct Entity;
+
+// Potentially visible set of static entities for every cell of a uniform grid. Entities are identified by their
+// PackedArray slot (Entity::id & INDEX_MASK), which stays stable while other entities are added or removed.
+struct PVS
+{
+    AABB                  bounds;
+    float                 cell_size = 0.0f;
+    uint32_t              dims[3]   = { 0, 0, 0 };
+    std::vector<uint32_t> cell_offsets; // Byte offset of each cell into 'data', or PVS_INVALID_CELL for solid cells.
+    std::vector<uint8_t>  data;         // Zero-run-length encoded bitsets.
+};
+
+struct PVSBakeSettings
+{
+    float    cell_size = 2.0f;
+    uint32_t samples   = 64; // Rays per cell/entity pair before the entity is considered hidden.
+    uint32_t dilation  = 1;  // Merge in the sets of neighbouring cells to make up for missed samples.
+    uint32_t seed      = 1337;
+};
+
+// Caches the decompressed set of the cell the camera was in last, so the runtime only decodes on cell changes. Reset 'cell' to
+// PVS_INVALID_CELL whenever the PVS is reloaded or rebaked, otherwise the cached bits of the old data stay in use.
+struct PVSQuery
+{
+    uint32_t cell = PVS_INVALID_CELL;
+    uint64_t bits[PVS_ENTITY_WORDS];
+};
+
+// Offline bake. Static entity boxes act as occluders and as visibility targets; rays are traced against a BVH built over them.
+extern void bake_pvs(PVS& pvs, Entity* entities, uint32_t entity_count, const PVSBakeSettings& settings);
+extern bool save_pvs(const PVS& pvs, const std::string& path);
+extern bool load_pvs(PVS& pvs, const std::string& path);
+
+// Returns the cell containing 'position', or PVS_INVALID_CELL if it is outside the grid or solid.
+extern uint32_t pvs_cell(const PVS& pvs, const glm::vec3& position);
+
+// Decodes the set of 'cell' into 'bits', which must hold PVS_ENTITY_WORDS words. Returns false if the cell or its data is malformed.
+extern bool pvs_decompress(const PVS& pvs, uint32_t cell, uint64_t* bits);
+
+// Runtime pre-mask. Sets 'view_index' on every entity that passes the PVS of the camera cell and clears it on static entities
+// that don't. Dynamic entities always pass. Frustum culling afterwards only needs to test entities that still have the bit set.
+// Does nothing but set the bit on all entities if the camera is outside the grid.
+extern void apply_pvs(const PVS& pvs, PVSQuery& query, const glm::vec3& camera_position, Entity* entities, uint32_t entity_count, uint32_t view_index);
+} // namespace inferno
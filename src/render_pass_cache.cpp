@@ -0,0 +1,223 @@
+#include "render_pass_cache.h"
+#include "fast_hash.h"
+#include "logger.h"
+#include "macros.h"
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void add_attachment_references(FieldHasher& h, const VkAttachmentReference* refs, uint32_t count)
+{
+    h.add(refs != nullptr);
+
+    if (!refs)
+        return;
+
+    for (uint32_t i = 0; i < count; i++)
+        h.add(refs[i].attachment).add(refs[i].layout);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+RenderPassCache::Ptr RenderPassCache::create(Backend::Ptr backend)
+{
+    return std::shared_ptr<RenderPassCache>(new RenderPassCache(backend));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+RenderPassCache::RenderPassCache(Backend::Ptr backend) :
+    Object(backend)
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+RenderPassCache::~RenderPassCache()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+RenderPass::Ptr RenderPassCache::get(const std::vector<VkAttachmentDescription>& attachment_descs, const std::vector<VkSubpassDescription>& subpass_descs, const std::vector<VkSubpassDependency>& subpass_deps)
+{
+    FieldHasher h;
+
+    h.add(uint32_t(attachment_descs.size())).add(uint32_t(subpass_descs.size())).add(uint32_t(subpass_deps.size()));
+
+    for (const auto& att : attachment_descs)
+    {
+        h.add(att.flags).add(att.format).add(att.samples).add(att.loadOp).add(att.storeOp);
+        h.add(att.stencilLoadOp).add(att.stencilStoreOp).add(att.initialLayout).add(att.finalLayout);
+    }
+
+    for (const auto& subpass : subpass_descs)
+    {
+        h.add(subpass.flags).add(subpass.pipelineBindPoint).add(subpass.inputAttachmentCount).add(subpass.colorAttachmentCount).add(subpass.preserveAttachmentCount);
+
+        add_attachment_references(h, subpass.pInputAttachments, subpass.inputAttachmentCount);
+        add_attachment_references(h, subpass.pColorAttachments, subpass.colorAttachmentCount);
+        add_attachment_references(h, subpass.pResolveAttachments, subpass.colorAttachmentCount);
+        add_attachment_references(h, subpass.pDepthStencilAttachment, 1);
+
+        for (uint32_t i = 0; i < subpass.preserveAttachmentCount; i++)
+            h.add(subpass.pPreserveAttachments[i]);
+    }
+
+    for (const auto& dep : subpass_deps)
+        h.add(dep.srcSubpass).add(dep.dstSubpass).add(dep.srcStageMask).add(dep.dstStageMask).add(dep.srcAccessMask).add(dep.dstAccessMask).add(dep.dependencyFlags);
+
+    uint64_t        key = h.result();
+    RenderPass::Ptr render_pass;
+
+    if (m_render_passes.get(key, render_pass))
+        return render_pass;
+
+    render_pass = RenderPass::create(m_vk_backend.lock(), attachment_descs, subpass_descs, subpass_deps);
+    m_render_passes.set(key, render_pass);
+
+    return render_pass;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void RenderPassCache::clear()
+{
+    m_render_passes.clear();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+FramebufferCache::Ptr FramebufferCache::create(Backend::Ptr backend)
+{
+    return std::shared_ptr<FramebufferCache>(new FramebufferCache(backend));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+FramebufferCache::FramebufferCache(Backend::Ptr backend) :
+    Object(backend)
+{
+    m_frames_in_flight = backend->frames_in_flight();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+FramebufferCache::~FramebufferCache()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+
+    // Nothing that is still in flight may be destroyed.
+    m_vk_backend.lock()->wait_idle();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void FramebufferCache::begin_frame(const FrameContext& frame)
+{
+    m_frame_number = frame.frame_number;
+
+    // The GPU has finished every frame older than the frames in flight, so their framebuffers can go.
+    size_t retired = 0;
+
+    while (retired < m_retired.size() && m_retired[retired].frame + m_frames_in_flight <= m_frame_number)
+        retired++;
+
+    m_retired.erase(m_retired.begin(), m_retired.begin() + retired);
+
+    for (uint32_t i = 0; i < m_entries.size();)
+    {
+        Entry& entry = m_entries[i];
+        bool   stale = entry.last_used_frame + FRAMEBUFFER_CACHE_MAX_UNUSED_FRAMES < m_frame_number;
+
+        for (const auto& view : entry.views)
+            stale = stale || view.expired();
+
+        if (stale)
+            evict(i);
+        else
+            i++;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Framebuffer::Ptr FramebufferCache::get(RenderPass::Ptr render_pass, const std::vector<ImageView::Ptr>& views, uint32_t width, uint32_t height, uint32_t layers)
+{
+    FieldHasher h;
+
+    h.add(render_pass->compatibility_hash()).add(width).add(height).add(layers).add(uint32_t(views.size()));
+
+    for (const auto& view : views)
+        h.add(view->id());
+
+    uint64_t key   = h.result();
+    uint32_t index = 0;
+
+    if (m_indices.get(key, index))
+    {
+        m_entries[index].last_used_frame = m_frame_number;
+        return m_entries[index].framebuffer;
+    }
+
+    Entry entry;
+
+    entry.key             = key;
+    entry.last_used_frame = m_frame_number;
+    entry.framebuffer     = Framebuffer::create(m_vk_backend.lock(), render_pass, views, width, height, layers);
+    entry.views.assign(views.begin(), views.end());
+
+    m_indices.set(key, uint32_t(m_entries.size()));
+    m_entries.push_back(std::move(entry));
+
+    return m_entries.back().framebuffer;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void FramebufferCache::clear()
+{
+    m_vk_backend.lock()->wait_idle();
+
+    m_indices.clear();
+    m_entries.clear();
+    m_retired.clear();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void FramebufferCache::evict(uint32_t index)
+{
+    Retired retired;
+
+    retired.frame       = m_entries[index].last_used_frame;
+    retired.framebuffer = std::move(m_entries[index].framebuffer);
+
+    m_retired.push_back(std::move(retired));
+    m_indices.remove(m_entries[index].key);
+
+    // Swap with the last entry to keep the array packed.
+    if (index != m_entries.size() - 1)
+    {
+        m_entries[index] = std::move(m_entries.back());
+        m_indices.set(m_entries[index].key, index);
+    }
+
+    m_entries.pop_back();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
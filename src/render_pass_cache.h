@@ -0,0 +1,88 @@
+#pragma once
+
+#include "vk.h"
+#include "flat_hash_map.h"
+#include <stdint.h>
+
+// Number of frames a cached framebuffer may go unused before it is evicted.
+#define FRAMEBUFFER_CACHE_MAX_UNUSED_FRAMES 60
+
+namespace inferno
+{
+namespace vk
+{
+// Returns an existing render pass for every attachment configuration seen before. The key covers everything the render pass is
+// created from, including load/store ops and layouts, so only truly identical passes are shared. Not thread-safe.
+class RenderPassCache : public Object
+{
+public:
+    using Ptr = std::shared_ptr<RenderPassCache>;
+
+    static RenderPassCache::Ptr create(Backend::Ptr backend);
+
+    ~RenderPassCache();
+
+    RenderPass::Ptr get(const std::vector<VkAttachmentDescription>& attachment_descs, const std::vector<VkSubpassDescription>& subpass_descs, const std::vector<VkSubpassDependency>& subpass_deps);
+
+    void clear();
+
+    inline uint32_t size() { return m_render_passes.size(); }
+
+private:
+    RenderPassCache(Backend::Ptr backend);
+
+private:
+    FlatHashMap<uint64_t, RenderPass::Ptr> m_render_passes;
+};
+
+// Returns an existing framebuffer for the same render pass compatibility class, image views and extent. Views are identified by
+// ImageView::id(), so a destroyed view can never alias a new one.
+//
+// Entries whose views have been destroyed, e.g. by swap chain recreation or a resize of an offscreen target, or that haven't been
+// used for FRAMEBUFFER_CACHE_MAX_UNUSED_FRAMES frames are evicted by begin_frame(). The framebuffer itself is only destroyed once
+// every frame in flight that could still reference it has completed. Not thread-safe.
+class FramebufferCache : public Object
+{
+public:
+    using Ptr = std::shared_ptr<FramebufferCache>;
+
+    static FramebufferCache::Ptr create(Backend::Ptr backend);
+
+    ~FramebufferCache();
+
+    // Call once per frame after Backend::begin_frame().
+    void begin_frame(const FrameContext& frame);
+
+    Framebuffer::Ptr get(RenderPass::Ptr render_pass, const std::vector<ImageView::Ptr>& views, uint32_t width, uint32_t height, uint32_t layers = 1);
+
+    void clear();
+
+    inline uint32_t size() { return uint32_t(m_entries.size()); }
+
+private:
+    struct Entry
+    {
+        uint64_t                              key;
+        uint64_t                              last_used_frame;
+        Framebuffer::Ptr                      framebuffer;
+        std::vector<std::weak_ptr<ImageView>> views;
+    };
+
+    struct Retired
+    {
+        uint64_t         frame;
+        Framebuffer::Ptr framebuffer;
+    };
+
+    FramebufferCache(Backend::Ptr backend);
+    void evict(uint32_t index);
+
+private:
+    FlatHashMap<uint64_t, uint32_t> m_indices;
+    std::vector<Entry>              m_entries;
+    std::vector<Retired>            m_retired;
+    uint32_t                        m_frames_in_flight;
+    uint64_t                        m_frame_number = 0;
+};
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "macros.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define CACHE_LINE_SIZE 64
+
+namespace inferno
+{
+// Lock-free ring buffer for exactly one producer thread and one consumer thread. Each side keeps a private copy of the other
+// side's index and only reloads it when the ring looks full or empty, so in steady state push() and pop() touch no shared cache
+// lines besides the slot itself. N must be a power of two.
+template <typename T, size_t N>
+class SPSCQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCQueue size must be a power of two.");
+
+public:
+    SPSCQueue()
+    {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_cached_head = 0;
+        m_cached_tail = 0;
+    }
+
+    ~SPSCQueue()
+    {
+    }
+
+    // Producer only. Returns false if the queue is full.
+    bool push(const T& value)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_cached_head == N)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+
+            if (tail - m_cached_head == N)
+                return false;
+        }
+
+        m_data[tail & (N - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Consumer only. Returns false if the queue is empty.
+    bool pop(T& value)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_cached_tail)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+
+            if (head == m_cached_tail)
+                return false;
+        }
+
+        value = m_data[head & (N - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Only exact when called from one of the two threads while the other is idle.
+    size_t size()
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    // Producer and consumer state live on separate cache lines so the two threads don't invalidate each other's.
+    INFERNO_ALIGNED(CACHE_LINE_SIZE) std::atomic<size_t> m_tail;
+    size_t m_cached_head;
+    INFERNO_ALIGNED(CACHE_LINE_SIZE) std::atomic<size_t> m_head;
+    size_t m_cached_tail;
+    INFERNO_ALIGNED(CACHE_LINE_SIZE) T m_data[N];
+};
+
+// Bounded lock-free ring buffer for any number of producers and consumers. Every slot carries a sequence number that tells
+// whether it is ready to be written or read in the current lap, so a thread claims a slot with a single compare-exchange on the
+// shared index and never waits for other threads unless the queue is full or empty. N must be a power of two.
+template <typename T, size_t N>
+class MPMCQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MPMCQueue size must be a power of two.");
+
+public:
+    MPMCQueue()
+    {
+        for (size_t i = 0; i < N; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    ~MPMCQueue()
+    {
+    }
+
+    // Returns false if the queue is full.
+    bool push(const T& value)
+    {
+        Cell*  cell;
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell          = &m_cells[pos & (N - 1)];
+            size_t   seq  = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+
+            if (diff == 0)
+            {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+
+        cell->data = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Returns false if the queue is empty.
+    bool pop(T& value)
+    {
+        Cell*  cell;
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            cell          = &m_cells[pos & (N - 1)];
+            size_t   seq  = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+
+            if (diff == 0)
+            {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+
+        value = cell->data;
+        cell->sequence.store(pos + N, std::memory_order_release);
+
+        return true;
+    }
+
+    // Approximate while other threads are pushing or popping.
+    size_t size()
+    {
+        size_t enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        size_t dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+    INFERNO_ALIGNED(CACHE_LINE_SIZE) Cell m_cells[N];
+    INFERNO_ALIGNED(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueue_pos;
+    INFERNO_ALIGNED(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeue_pos;
+};
+} // namespace inferno
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <type_traits>
+#include <stdexcept>
+#include "logger.h"
+
+namespace inferno
+{
+// Vector with a fixed capacity of N elements stored inline. Never allocates, copies with a plain memcpy and unused elements are
+// kept zeroed, so as long as T has no padding two SmallVectors with equal contents are also equal byte for byte and can be
+// hashed as a whole.
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector only holds trivially copyable types.");
+
+public:
+    SmallVector() :
+        m_size(0)
+    {
+        memset(&m_data[0], 0, sizeof(m_data));
+    }
+
+    // Overflowing the inline storage is a programming error that would otherwise corrupt whatever follows it, so it fails in
+    // every build rather than only under assert. Callers that can legitimately run out of room check full() first.
+    inline void push_back(const T& value)
+    {
+        if (m_size == N)
+        {
+            INFERNO_LOG_FATAL("SmallVector capacity exceeded.");
+            throw std::runtime_error("SmallVector capacity exceeded.");
+        }
+
+        m_data[m_size++] = value;
+    }
+
+    inline void pop_back()
+    {
+        assert(m_size > 0 && "No elements in SmallVector to pop");
+        memset(&m_data[--m_size], 0, sizeof(T));
+    }
+
+    inline void clear()
+    {
+        memset(&m_data[0], 0, sizeof(T) * m_size);
+        m_size = 0;
+    }
+
+    inline T&       operator[](size_t i) { return m_data[i]; }
+    inline const T& operator[](size_t i) const { return m_data[i]; }
+    inline T*       data() { return &m_data[0]; }
+    inline const T* data() const { return &m_data[0]; }
+    inline T*       begin() { return &m_data[0]; }
+    inline const T* begin() const { return &m_data[0]; }
+    inline T*       end() { return &m_data[0] + m_size; }
+    inline const T* end() const { return &m_data[0] + m_size; }
+    inline uint32_t size() const { return m_size; }
+    inline bool     empty() const { return m_size == 0; }
+    inline bool     full() const { return m_size == N; }
+
+    static constexpr size_t capacity() { return N; }
+
+    bool operator==(const SmallVector& other) const
+    {
+        return m_size == other.m_size && memcmp(&m_data[0], &other.m_data[0], sizeof(T) * m_size) == 0;
+    }
+
+    bool operator!=(const SmallVector& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    uint32_t m_size;
+    T        m_data[N];
+};
+
+// Null-terminated string of up to N - 1 characters stored inline. Zero-padded like SmallVector, so it can be copied, compared
+// and hashed as plain bytes.
+template <size_t N>
+class FixedString
+{
+public:
+    FixedString()
+    {
+        memset(&m_data[0], 0, N);
+    }
+
+    FixedString(const char* str)
+    {
+        memset(&m_data[0], 0, N);
+        assign(str);
+    }
+
+    void assign(const char* str)
+    {
+        size_t length = strlen(str);
+
+        // A truncated string would silently name something else, e.g. a different shader entry point.
+        if (length >= N)
+        {
+            INFERNO_LOG_FATAL("FixedString capacity exceeded.");
+            throw std::runtime_error("FixedString capacity exceeded.");
+        }
+
+        memcpy(&m_data[0], str, length);
+        memset(&m_data[length], 0, N - length);
+    }
+
+    FixedString& operator=(const char* str)
+    {
+        assign(str);
+        return *this;
+    }
+
+    inline const char* c_str() const { return &m_data[0]; }
+    inline size_t      size() const { return strlen(&m_data[0]); }
+    inline bool        empty() const { return m_data[0] == 0; }
+
+    bool operator==(const FixedString& other) const
+    {
+        return memcmp(&m_data[0], &other.m_data[0], N) == 0;
+    }
+
+    bool operator!=(const FixedString& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    char m_data[N];
+};
+} // namespace inferno
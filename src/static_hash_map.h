@@ -1,17 +1,16 @@
 #pragma once
 
-#include "deque.h"
 #include "murmur_hash.h"
+#include <string.h>
 
 namespace inferno
 {
-template <typename T>
-uint64_t create_hash(const T& key)
-{
-    return murmur_hash_64(&key, sizeof(T), 0);
-}
-
-template <typename KEY, typename VALUE, size_t SIZE>
+// Chained hash map with a fixed capacity. Entries are identified by the 64-bit hash of their key; with VERIFY_KEYS set, the
+// original keys are compared as well so that colliding hashes can't alias each other. KEY then needs operator==.
+//
+// Entries stay packed at the front of the data arrays, so they need no initialization until they are used. Buckets are only
+// valid if their epoch matches the map's, which lets clear() drop everything by bumping the epoch.
+template <typename KEY, typename VALUE, size_t SIZE, bool VERIFY_KEYS = false>
 class StaticHashMap
 {
 public:
@@ -22,28 +21,24 @@ public:
         uint32_t data_index;
     };
 
-    uint32_t              m_hash[SIZE];
-    Deque<uint32_t, SIZE> m_free_indices;
-    uint64_t              m_key[SIZE];
-    uint32_t              m_next[SIZE];
-    uint32_t              m_prev[SIZE];
-    VALUE                 m_value[SIZE];
-    KEY                   m_key_original[SIZE];
-    uint32_t              m_num_objects;
-    const uint32_t        INVALID_INDEX = 0xffffffffu;
+    uint32_t       m_hash[SIZE];
+    uint32_t       m_hash_epoch[SIZE];
+    uint64_t       m_key[SIZE];
+    uint32_t       m_next[SIZE];
+    uint32_t       m_prev[SIZE];
+    VALUE          m_value[SIZE];
+    KEY            m_key_original[SIZE];
+    uint32_t       m_num_objects;
+    uint32_t       m_epoch;
+    const uint32_t INVALID_INDEX = 0xffffffffu;
 
 public:
     StaticHashMap()
     {
-        for (uint32_t i = 0; i < SIZE; ++i)
-        {
-            m_hash[i] = INVALID_INDEX;
-            m_next[i] = INVALID_INDEX;
-            m_prev[i] = INVALID_INDEX;
-            m_free_indices.push_back(i);
-        }
+        memset(&m_hash_epoch[0], 0, sizeof(m_hash_epoch));
 
         m_num_objects = 0;
+        m_epoch       = 1;
     }
 
     ~StaticHashMap()
@@ -52,20 +47,20 @@ public:
 
     void set(const KEY& key, const VALUE& value)
     {
-        uint32_t data_index        = find_or_make(create_hash(key));
+        uint32_t data_index        = find_or_make(key, create_hash(key));
         m_key_original[data_index] = key;
         m_value[data_index]        = value;
     }
 
     bool has(const KEY& key)
     {
-        uint32_t data_index = find_or_fail(create_hash(key));
+        uint32_t data_index = find_or_fail(key, create_hash(key));
         return data_index != INVALID_INDEX;
     }
 
     bool get(const KEY& key, VALUE& object)
     {
-        uint32_t data_index = find_or_fail(create_hash(key));
+        uint32_t data_index = find_or_fail(key, create_hash(key));
 
         if (data_index == INVALID_INDEX)
             return false;
@@ -78,7 +73,7 @@ public:
 
     VALUE* get_ptr(const KEY& key)
     {
-        uint32_t data_index = find_or_fail(create_hash(key));
+        uint32_t data_index = find_or_fail(key, create_hash(key));
 
         if (data_index == INVALID_INDEX)
             return nullptr;
@@ -88,7 +83,7 @@ public:
 
     void remove(const KEY& key)
     {
-        FindResult result = find(create_hash(key));
+        FindResult result = find(key, create_hash(key));
 
         // check if key actually exists
         if (result.data_index != INVALID_INDEX)
@@ -97,8 +92,14 @@ public:
 
     void clear()
     {
-        for (uint32_t i = 0; i < m_num_objects; i++)
-            remove(m_key[i]);
+        m_num_objects = 0;
+
+        // Only pay for a full reset once every 2^32 clears.
+        if (++m_epoch == 0)
+        {
+            memset(&m_hash_epoch[0], 0, sizeof(m_hash_epoch));
+            m_epoch = 1;
+        }
     }
 
     uint32_t size()
@@ -107,7 +108,23 @@ public:
     }
 
 private:
-    FindResult find(const uint64_t& key)
+    inline uint32_t bucket(uint32_t hash_index)
+    {
+        return m_hash_epoch[hash_index] == m_epoch ? m_hash[hash_index] : INVALID_INDEX;
+    }
+
+    inline void set_bucket(uint32_t hash_index, uint32_t data_index)
+    {
+        m_hash[hash_index]       = data_index;
+        m_hash_epoch[hash_index] = m_epoch;
+    }
+
+    inline bool matches(uint32_t data_index, const KEY& key, const uint64_t& hash)
+    {
+        return m_key[data_index] == hash && (!VERIFY_KEYS || m_key_original[data_index] == key);
+    }
+
+    FindResult find(const KEY& key, const uint64_t& hash)
     {
         FindResult result;
 
@@ -115,12 +132,12 @@ private:
         result.data_prev_index = INVALID_INDEX;
         result.data_index      = INVALID_INDEX;
 
-        result.hash_index = key % SIZE;
-        result.data_index = m_hash[result.hash_index];
+        result.hash_index = hash % SIZE;
+        result.data_index = bucket(result.hash_index);
 
         while (result.data_index != INVALID_INDEX)
         {
-            if (m_key[result.data_index] == key)
+            if (matches(result.data_index, key, hash))
                 return result;
 
             result.data_prev_index = result.data_index;
@@ -131,32 +148,30 @@ private:
     }
 
     // tries to find an object. if not found returns INVALID_INDEX.
-    uint32_t find_or_fail(const uint64_t& key)
+    uint32_t find_or_fail(const KEY& key, const uint64_t& hash)
     {
-        FindResult result = find(key);
+        FindResult result = find(key, hash);
         return result.data_index;
     }
 
     // tries to find an object. if not found creates Hash Entry.
-    uint32_t find_or_make(const uint64_t& key)
+    uint32_t find_or_make(const KEY& key, const uint64_t& hash)
     {
-        FindResult result = find(key);
+        FindResult result = find(key, hash);
 
         if (result.data_index == INVALID_INDEX)
         {
-            result.data_index         = m_free_indices.pop_front();
+            result.data_index         = m_num_objects;
             m_next[result.data_index] = INVALID_INDEX;
-            m_key[result.data_index]  = key;
+            m_prev[result.data_index] = result.data_prev_index;
+            m_key[result.data_index]  = hash;
             m_num_objects++;
 
             if (result.data_prev_index != INVALID_INDEX)
-            {
                 m_next[result.data_prev_index] = result.data_index;
-                m_prev[result.data_index]      = result.data_prev_index;
-            }
 
-            if (m_hash[result.hash_index] == INVALID_INDEX)
-                m_hash[result.hash_index] = result.data_index;
+            if (bucket(result.hash_index) == INVALID_INDEX)
+                set_bucket(result.hash_index, result.data_index);
         }
 
         return result.data_index;
@@ -166,12 +181,10 @@ private:
     {
         uint32_t last_data_index = m_num_objects - 1;
         m_num_objects--;
-        // push last items' index into freelist
-        m_free_indices.push_front(last_data_index);
 
         // Handle the element to be deleted
         if (result.data_prev_index == INVALID_INDEX)
-            m_hash[result.hash_index] = INVALID_INDEX;
+            set_bucket(result.hash_index, m_next[result.data_index]);
         else
             m_next[result.data_prev_index] = m_next[result.data_index];
 
@@ -182,10 +195,7 @@ private:
         {
             // Handle the last element
             if (m_prev[last_data_index] == INVALID_INDEX)
-            {
-                uint64_t last_hash_index = m_key[last_data_index] % SIZE;
-                m_hash[last_hash_index]  = result.data_index;
-            }
+                set_bucket(uint32_t(m_key[last_data_index] % SIZE), result.data_index);
             else
                 m_next[m_prev[last_data_index]] = result.data_index;
 
@@ -193,10 +203,11 @@ private:
                 m_prev[m_next[last_data_index]] = result.data_index;
 
             // Swap elements
-            m_key[result.data_index]   = m_key[last_data_index];
-            m_next[result.data_index]  = m_next[last_data_index];
-            m_prev[result.data_index]  = m_prev[last_data_index];
-            m_value[result.data_index] = m_value[last_data_index];
+            m_key[result.data_index]          = m_key[last_data_index];
+            m_next[result.data_index]         = m_next[last_data_index];
+            m_prev[result.data_index]         = m_prev[last_data_index];
+            m_value[result.data_index]        = m_value[last_data_index];
+            m_key_original[result.data_index] = m_key_original[last_data_index];
         }
     }
 };
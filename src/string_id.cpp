@@ -0,0 +1,67 @@
+#include "string_id.h"
+#include "logger.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace inferno
+{
+#if defined(INFERNO_STRING_ID_NAMES)
+static std::mutex                                g_name_table_mutex;
+static std::unordered_map<uint64_t, std::string> g_name_table;
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+StringID::StringID(const std::string& str) :
+    hash(murmur_hash_64(str.c_str(), uint32_t(str.size()), 0))
+{
+#if defined(INFERNO_STRING_ID_NAMES)
+    std::lock_guard<std::mutex> lock(g_name_table_mutex);
+
+    auto it = g_name_table.find(hash);
+
+    if (it == g_name_table.end())
+        it = g_name_table.emplace(hash, str).first;
+    else if (it->second != str)
+        INFERNO_LOG_WARNING("(StringID) Hash collision between '" + it->second + "' and '" + str + "'.");
+
+    // Nodes of an unordered_map never move, so the pointer stays valid for the lifetime of the table.
+    debug_name = it->second.c_str();
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const char* StringID::name() const
+{
+#if defined(INFERNO_STRING_ID_NAMES)
+    if (debug_name)
+        return debug_name;
+
+    const char* table_name = string_id_name(hash);
+
+    if (table_name)
+        return table_name;
+#endif
+
+    return "<unknown>";
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const char* string_id_name(uint64_t hash)
+{
+#if defined(INFERNO_STRING_ID_NAMES)
+    std::lock_guard<std::mutex> lock(g_name_table_mutex);
+
+    auto it = g_name_table.find(hash);
+
+    if (it != g_name_table.end())
+        return it->second.c_str();
+#endif
+
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace inferno
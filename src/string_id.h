@@ -0,0 +1,64 @@
+#pragma once
+
+#include "murmur_hash.h"
+#include <stdint.h>
+#include <string>
+
+// Debug builds keep the strings behind every StringID around for reverse lookup.
+#if !defined(NDEBUG)
+#    define INFERNO_STRING_ID_NAMES
+#endif
+
+namespace inferno
+{
+// Hashed string identifier for resource and pass names. String literals are hashed at compile time through "name"_sid; other
+// strings are hashed at runtime. Comparisons only look at the hash.
+struct StringID
+{
+    uint64_t hash = 0;
+#if defined(INFERNO_STRING_ID_NAMES)
+    const char* debug_name = nullptr;
+#endif
+
+    constexpr StringID() {}
+
+    // Runtime strings. In debug builds the string is added to the name table so name() can find it later.
+    explicit StringID(const std::string& str);
+
+    // Returns the original string in debug builds if it is known, otherwise a placeholder.
+    const char* name() const;
+
+    constexpr bool operator==(const StringID& other) const { return hash == other.hash; }
+    constexpr bool operator!=(const StringID& other) const { return hash != other.hash; }
+    constexpr bool operator<(const StringID& other) const { return hash < other.hash; }
+};
+
+// 'str' is kept as the debug name without copying, so it must outlive the ID. Meant for string literals; use the std::string
+// constructor for anything else.
+constexpr StringID make_string_id(const char* str, size_t len)
+{
+    StringID id;
+    id.hash = murmur_hash_64_constexpr(str, uint32_t(len), 0);
+#if defined(INFERNO_STRING_ID_NAMES)
+    id.debug_name = str;
+#endif
+    return id;
+}
+
+// "name"_sid builds a StringID at compile time.
+constexpr StringID operator"" _sid(const char* str, size_t len)
+{
+    return make_string_id(str, len);
+}
+
+// Maps keyed by StringID reuse the precomputed hash instead of hashing the struct.
+template <>
+inline uint64_t create_hash<StringID>(const StringID& key)
+{
+    return key.hash;
+}
+
+// Reverse lookup of a hash in the debug name table, which holds the strings of all runtime-constructed IDs. Returns nullptr if
+// unknown or in release builds.
+extern const char* string_id_name(uint64_t hash);
+} // namespace inferno
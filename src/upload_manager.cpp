@@ -0,0 +1,664 @@
+#include "upload_manager.h"
+#include "logger.h"
+#include "macros.h"
+#include <vk_mem_alloc.h>
+#include <string.h>
+#include <algorithm>
+
+namespace inferno
+{
+namespace vk
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Size in bytes of one texel, or of one block for block-compressed formats. Returns 0 for formats that uploads don't support,
+// such as depth/stencil and multi-planar formats.
+static uint32_t texel_block_size(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R4G4_UNORM_PACK8:
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SNORM:
+        case VK_FORMAT_R8_USCALED:
+        case VK_FORMAT_R8_SSCALED:
+        case VK_FORMAT_R8_UINT:
+        case VK_FORMAT_R8_SINT:
+        case VK_FORMAT_R8_SRGB:
+            return 1;
+
+        case VK_FORMAT_R4G4B4A4_UNORM_PACK16:
+        case VK_FORMAT_B4G4R4A4_UNORM_PACK16:
+        case VK_FORMAT_R5G6B5_UNORM_PACK16:
+        case VK_FORMAT_B5G6R5_UNORM_PACK16:
+        case VK_FORMAT_R5G5B5A1_UNORM_PACK16:
+        case VK_FORMAT_B5G5R5A1_UNORM_PACK16:
+        case VK_FORMAT_A1R5G5B5_UNORM_PACK16:
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SNORM:
+        case VK_FORMAT_R8G8_USCALED:
+        case VK_FORMAT_R8G8_SSCALED:
+        case VK_FORMAT_R8G8_UINT:
+        case VK_FORMAT_R8G8_SINT:
+        case VK_FORMAT_R8G8_SRGB:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SNORM:
+        case VK_FORMAT_R16_USCALED:
+        case VK_FORMAT_R16_SSCALED:
+        case VK_FORMAT_R16_UINT:
+        case VK_FORMAT_R16_SINT:
+        case VK_FORMAT_R16_SFLOAT:
+            return 2;
+
+        case VK_FORMAT_R8G8B8_UNORM:
+        case VK_FORMAT_R8G8B8_SNORM:
+        case VK_FORMAT_R8G8B8_USCALED:
+        case VK_FORMAT_R8G8B8_SSCALED:
+        case VK_FORMAT_R8G8B8_UINT:
+        case VK_FORMAT_R8G8B8_SINT:
+        case VK_FORMAT_R8G8B8_SRGB:
+        case VK_FORMAT_B8G8R8_UNORM:
+        case VK_FORMAT_B8G8R8_SNORM:
+        case VK_FORMAT_B8G8R8_USCALED:
+        case VK_FORMAT_B8G8R8_SSCALED:
+        case VK_FORMAT_B8G8R8_UINT:
+        case VK_FORMAT_B8G8R8_SINT:
+        case VK_FORMAT_B8G8R8_SRGB:
+            return 3;
+
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R8G8B8A8_USCALED:
+        case VK_FORMAT_R8G8B8A8_SSCALED:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R8G8B8A8_SINT:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SNORM:
+        case VK_FORMAT_B8G8R8A8_USCALED:
+        case VK_FORMAT_B8G8R8A8_SSCALED:
+        case VK_FORMAT_B8G8R8A8_UINT:
+        case VK_FORMAT_B8G8R8A8_SINT:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+        case VK_FORMAT_A8B8G8R8_SNORM_PACK32:
+        case VK_FORMAT_A8B8G8R8_USCALED_PACK32:
+        case VK_FORMAT_A8B8G8R8_SSCALED_PACK32:
+        case VK_FORMAT_A8B8G8R8_UINT_PACK32:
+        case VK_FORMAT_A8B8G8R8_SINT_PACK32:
+        case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+        case VK_FORMAT_A2R10G10B10_UNORM_PACK32:
+        case VK_FORMAT_A2R10G10B10_SNORM_PACK32:
+        case VK_FORMAT_A2R10G10B10_USCALED_PACK32:
+        case VK_FORMAT_A2R10G10B10_SSCALED_PACK32:
+        case VK_FORMAT_A2R10G10B10_UINT_PACK32:
+        case VK_FORMAT_A2R10G10B10_SINT_PACK32:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+        case VK_FORMAT_A2B10G10R10_USCALED_PACK32:
+        case VK_FORMAT_A2B10G10R10_SSCALED_PACK32:
+        case VK_FORMAT_A2B10G10R10_UINT_PACK32:
+        case VK_FORMAT_A2B10G10R10_SINT_PACK32:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_USCALED:
+        case VK_FORMAT_R16G16_SSCALED:
+        case VK_FORMAT_R16G16_UINT:
+        case VK_FORMAT_R16G16_SINT:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+            return 4;
+
+        case VK_FORMAT_R16G16B16_UNORM:
+        case VK_FORMAT_R16G16B16_SNORM:
+        case VK_FORMAT_R16G16B16_USCALED:
+        case VK_FORMAT_R16G16B16_SSCALED:
+        case VK_FORMAT_R16G16B16_UINT:
+        case VK_FORMAT_R16G16B16_SINT:
+        case VK_FORMAT_R16G16B16_SFLOAT:
+            return 6;
+
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SNORM:
+        case VK_FORMAT_R16G16B16A16_USCALED:
+        case VK_FORMAT_R16G16B16A16_SSCALED:
+        case VK_FORMAT_R16G16B16A16_UINT:
+        case VK_FORMAT_R16G16B16A16_SINT:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_UINT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32_SFLOAT:
+        case VK_FORMAT_R64_UINT:
+        case VK_FORMAT_R64_SINT:
+        case VK_FORMAT_R64_SFLOAT:
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+            return 8;
+
+        case VK_FORMAT_R32G32B32_UINT:
+        case VK_FORMAT_R32G32B32_SINT:
+        case VK_FORMAT_R32G32B32_SFLOAT:
+            return 12;
+
+        case VK_FORMAT_R32G32B32A32_UINT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+        case VK_FORMAT_R64G64_UINT:
+        case VK_FORMAT_R64G64_SINT:
+        case VK_FORMAT_R64G64_SFLOAT:
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            return 16;
+
+        case VK_FORMAT_R64G64B64_UINT:
+        case VK_FORMAT_R64G64B64_SINT:
+        case VK_FORMAT_R64G64B64_SFLOAT:
+            return 24;
+
+        case VK_FORMAT_R64G64B64A64_UINT:
+        case VK_FORMAT_R64G64B64A64_SINT:
+        case VK_FORMAT_R64G64B64A64_SFLOAT:
+            return 32;
+
+        default:
+            return 0;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Width and height in texels of one block of the formats texel_block_size() supports. 1x1 for uncompressed formats.
+static void texel_block_extent(VkFormat format, uint32_t& width, uint32_t& height)
+{
+    switch (format)
+    {
+        case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+            width = height = 5;
+            break;
+
+        case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+            width = height = 6;
+            break;
+
+        case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+        case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+            width = height = 8;
+            break;
+
+        default:
+            // Every other block-compressed format in the table (BC, ETC2, EAC, ASTC 4x4) uses 4x4 blocks.
+            bool compressed = (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK) || format == VK_FORMAT_ASTC_4x4_UNORM_BLOCK || format == VK_FORMAT_ASTC_4x4_SRGB_BLOCK;
+
+            width = height = compressed ? 4 : 1;
+            break;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static size_t least_common_multiple(size_t a, size_t b)
+{
+    size_t x = a;
+    size_t y = b;
+
+    while (y != 0)
+    {
+        size_t r = x % y;
+
+        x = y;
+        y = r;
+    }
+
+    return a / x * b;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+UploadManager::Ptr UploadManager::create(Backend::Ptr backend, size_t staging_size)
+{
+    return std::shared_ptr<UploadManager>(new UploadManager(backend, staging_size));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+UploadManager::UploadManager(Backend::Ptr backend, size_t staging_size) :
+    Object(backend)
+{
+    QueueInfos& queues = backend->queue_infos();
+
+    m_vk_transfer_queue  = backend->transfer_queue();
+    m_transfer_family    = queues.transfer_queue_index;
+    m_graphics_family    = queues.graphics_queue_index;
+    m_ownership_transfer = m_transfer_family != m_graphics_family;
+    m_staging_size       = staging_size & ~size_t(UPLOAD_MANAGER_ALIGNMENT - 1);
+    m_command_pool       = CommandPool::create(backend, m_transfer_family);
+    m_staging            = Buffer::create(backend, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, m_staging_size, VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    m_staging_ptr        = static_cast<uint8_t*>(m_staging->mapped_ptr());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(backend->physical_device(), &properties);
+
+    m_copy_alignment = std::max(size_t(properties.limits.optimalBufferCopyOffsetAlignment), size_t(1));
+
+    VkFenceCreateInfo fence_info;
+    INFERNO_ZERO_MEMORY(fence_info);
+
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphore_info;
+    INFERNO_ZERO_MEMORY(semaphore_info);
+
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (auto& batch : m_batches)
+    {
+        batch.cmd = CommandBuffer::create(backend, m_command_pool);
+
+        if (vkCreateFence(m_vk_device, &fence_info, nullptr, &batch.vk_fence) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create Fence.");
+            throw std::runtime_error("(Vulkan) Failed to create Fence.");
+        }
+
+        if (m_ownership_transfer && vkCreateSemaphore(m_vk_device, &semaphore_info, nullptr, &batch.vk_semaphore) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create Semaphore.");
+            throw std::runtime_error("(Vulkan) Failed to create Semaphore.");
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+UploadManager::~UploadManager()
+{
+    if (backend_destroyed())
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
+        throw std::runtime_error("(Vulkan) Destructing after Device.");
+    }
+
+    while (retire_oldest(true))
+        ;
+
+    for (auto& batch : m_batches)
+    {
+        if (batch.vk_fence)
+            vkDestroyFence(m_vk_device, batch.vk_fence, nullptr);
+
+        if (batch.vk_semaphore)
+            vkDestroySemaphore(m_vk_device, batch.vk_semaphore, nullptr);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void UploadManager::upload_buffer(Buffer* dst, size_t dst_offset, const void* data, size_t size)
+{
+    const uint8_t* src       = static_cast<const uint8_t*>(data);
+    size_t         max_chunk = (m_staging_size / 2) & ~size_t(UPLOAD_MANAGER_ALIGNMENT - 1);
+
+    while (size > 0)
+    {
+        size_t chunk  = std::min(size, max_chunk);
+        size_t offset = allocate(chunk, UPLOAD_MANAGER_ALIGNMENT);
+
+        if (!m_recording)
+            begin_batch();
+
+        memcpy(m_staging_ptr + offset, src, chunk);
+
+        Batch& batch = m_batches[m_next_token % UPLOAD_MANAGER_MAX_BATCHES];
+
+        VkBufferCopy region;
+
+        region.srcOffset = offset;
+        region.dstOffset = dst_offset;
+        region.size      = chunk;
+
+        vkCmdCopyBuffer(batch.cmd->handle(), m_staging->handle(), dst->handle(), 1, &region);
+
+        VkBufferMemoryBarrier barrier;
+        INFERNO_ZERO_MEMORY(barrier);
+
+        barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT;
+        barrier.srcQueueFamilyIndex = m_ownership_transfer ? m_transfer_family : VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = m_ownership_transfer ? m_graphics_family : VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer              = dst->handle();
+        barrier.offset              = dst_offset;
+        barrier.size                = chunk;
+
+        batch.buffer_barriers.push_back(barrier);
+
+        src += chunk;
+        dst_offset += chunk;
+        size -= chunk;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void UploadManager::upload_image(Image* dst, const void* data, size_t size, uint32_t mip_level, uint32_t array_layer, VkImageLayout final_layout)
+{
+    uint32_t block_size = texel_block_size(dst->format());
+
+    if (block_size == 0)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Image format not supported by uploads.");
+        throw std::runtime_error("(Vulkan) Image format not supported by uploads.");
+    }
+
+    uint32_t block_width, block_height;
+    texel_block_extent(dst->format(), block_width, block_height);
+
+    uint32_t width    = std::max(dst->width() >> mip_level, 1u);
+    uint32_t height   = std::max(dst->height() >> mip_level, 1u);
+    uint32_t depth    = std::max(dst->depth() >> mip_level, 1u);
+    uint64_t required = uint64_t((width + block_width - 1) / block_width) * ((height + block_height - 1) / block_height) * depth * block_size;
+
+    // The copy reads the whole mip level, so anything shorter would read staging data that belongs to other uploads.
+    if (size < required)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Image upload smaller than the mip level it replaces.");
+        throw std::runtime_error("(Vulkan) Image upload smaller than the mip level it replaces.");
+    }
+
+    // The copy has to start at a multiple of the texel block size and of 4, and should start at a multiple of the optimal offset.
+    size_t alignment = least_common_multiple(least_common_multiple(block_size, UPLOAD_MANAGER_ALIGNMENT), m_copy_alignment);
+    size_t offset    = allocate(size_t(required), alignment);
+
+    if (!m_recording)
+        begin_batch();
+
+    memcpy(m_staging_ptr + offset, data, size_t(required));
+
+    Batch& batch = m_batches[m_next_token % UPLOAD_MANAGER_MAX_BATCHES];
+
+    VkImageMemoryBarrier barrier;
+    INFERNO_ZERO_MEMORY(barrier);
+
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask                   = 0;
+    barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = dst->handle();
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel   = mip_level;
+    barrier.subresourceRange.levelCount     = 1;
+    barrier.subresourceRange.baseArrayLayer = array_layer;
+    barrier.subresourceRange.layerCount     = 1;
+
+    vkCmdPipelineBarrier(batch.cmd->handle(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region;
+    INFERNO_ZERO_MEMORY(region);
+
+    region.bufferOffset                    = offset;
+    region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel       = mip_level;
+    region.imageSubresource.baseArrayLayer = array_layer;
+    region.imageSubresource.layerCount     = 1;
+    region.imageExtent.width               = width;
+    region.imageExtent.height              = height;
+    region.imageExtent.depth               = depth;
+
+    vkCmdCopyBufferToImage(batch.cmd->handle(), m_staging->handle(), dst->handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    // Moved to the final layout together with the release, or on its own if no ownership transfer is needed.
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout           = final_layout;
+    barrier.srcQueueFamilyIndex = m_ownership_transfer ? m_transfer_family : VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = m_ownership_transfer ? m_graphics_family : VK_QUEUE_FAMILY_IGNORED;
+
+    batch.image_barriers.push_back(barrier);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+UploadToken UploadManager::flush()
+{
+    if (!m_recording)
+        return m_next_token - 1;
+
+    Batch&          batch = m_batches[m_next_token % UPLOAD_MANAGER_MAX_BATCHES];
+    VkCommandBuffer cmd   = batch.cmd->handle();
+
+    // The release barriers have to match the acquire barriers exactly, so the same structs are recorded on both queues. Without
+    // an ownership transfer this is the only barrier, and it has to cover every later use on the graphics queue.
+    VkPipelineStageFlags dst_stage = m_ownership_transfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, dst_stage, 0, 0, nullptr, uint32_t(batch.buffer_barriers.size()), batch.buffer_barriers.data(), uint32_t(batch.image_barriers.size()), batch.image_barriers.data());
+
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to end Command Buffer.");
+        throw std::runtime_error("(Vulkan) Failed to end Command Buffer.");
+    }
+
+    VkSubmitInfo submit_info;
+    INFERNO_ZERO_MEMORY(submit_info);
+
+    submit_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers    = &cmd;
+
+    if (m_ownership_transfer)
+    {
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores    = &batch.vk_semaphore;
+    }
+
+    vkResetFences(m_vk_device, 1, &batch.vk_fence);
+
+    if (vkQueueSubmit(m_vk_transfer_queue, 1, &submit_info, batch.vk_fence) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to submit upload batch.");
+        throw std::runtime_error("(Vulkan) Failed to submit upload batch.");
+    }
+
+    if (!m_ownership_transfer)
+    {
+        batch.buffer_barriers.clear();
+        batch.image_barriers.clear();
+    }
+
+    batch.token    = m_next_token++;
+    batch.ring_end = m_ring_head;
+    batch.acquired = !m_ownership_transfer;
+    m_recording    = false;
+
+    return batch.token;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool UploadManager::is_complete(UploadToken token)
+{
+    while (m_completed_token < token && retire_oldest(false))
+        ;
+
+    return m_completed_token >= token;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void UploadManager::wait(UploadToken token)
+{
+    if (token >= m_next_token)
+        flush();
+
+    while (m_completed_token < token && retire_oldest(true))
+        ;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void UploadManager::acquire(VkCommandBuffer cmd, FrameVector<VkSemaphore>& wait_semaphores, FrameVector<VkPipelineStageFlags>& wait_stages)
+{
+    if (!m_ownership_transfer)
+        return;
+
+    UploadToken first = m_next_token > UPLOAD_MANAGER_MAX_BATCHES ? m_next_token - UPLOAD_MANAGER_MAX_BATCHES : 1;
+
+    for (UploadToken token = first; token < m_next_token; token++)
+    {
+        Batch& batch = m_batches[token % UPLOAD_MANAGER_MAX_BATCHES];
+
+        if (batch.token != token || batch.acquired)
+            continue;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, uint32_t(batch.buffer_barriers.size()), batch.buffer_barriers.data(), uint32_t(batch.image_barriers.size()), batch.image_barriers.data());
+
+        wait_semaphores.push_back(batch.vk_semaphore);
+        wait_stages.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+        batch.buffer_barriers.clear();
+        batch.image_barriers.clear();
+        batch.acquired = true;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+size_t UploadManager::allocate(size_t size, size_t alignment)
+{
+    if (size > m_staging_size)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Upload larger than the staging ring.");
+        throw std::runtime_error("(Vulkan) Upload larger than the staging ring.");
+    }
+
+    while (true)
+    {
+        // An empty ring starts over at the front so that any upload up to the full size fits.
+        if (m_ring_head == m_ring_tail)
+            m_ring_head = m_ring_tail = 0;
+
+        // The alignment applies to the offset into the staging buffer. It need not be a power of two, nor divide the ring size.
+        size_t   head   = size_t(m_ring_head % m_staging_size);
+        size_t   offset = (head + alignment - 1) / alignment * alignment;
+        uint64_t start  = m_ring_head + (offset - head);
+
+        // Allocations never wrap around the end of the ring.
+        if (offset + size > m_staging_size)
+        {
+            start  = m_ring_head + (m_staging_size - head);
+            offset = 0;
+        }
+
+        if (start + size - m_ring_tail <= m_staging_size)
+        {
+            m_ring_head = start + size;
+            return offset;
+        }
+
+        // Out of space: wait for the oldest batch, and if everything is still in the batch being recorded submit that first.
+        if (!retire_oldest(true))
+        {
+            flush();
+            retire_oldest(true);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void UploadManager::begin_batch()
+{
+    Batch& batch = m_batches[m_next_token % UPLOAD_MANAGER_MAX_BATCHES];
+
+    while (m_completed_token < batch.token)
+        retire_oldest(true);
+
+    // The semaphore of an unacquired batch would be signalled twice.
+    if (!batch.acquired)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Upload batch reused before it was acquired on the graphics queue.");
+        throw std::runtime_error("(Vulkan) Upload batch reused before it was acquired on the graphics queue.");
+    }
+
+    batch.cmd->reset();
+
+    VkCommandBufferBeginInfo begin_info;
+    INFERNO_ZERO_MEMORY(begin_info);
+
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(batch.cmd->handle(), &begin_info) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to begin Command Buffer.");
+        throw std::runtime_error("(Vulkan) Failed to begin Command Buffer.");
+    }
+
+    m_recording = true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Retires the oldest submitted batch and gives its staging space back. Returns false if nothing is in flight, or if 'block' is
+// false and the batch hasn't completed yet.
+bool UploadManager::retire_oldest(bool block)
+{
+    if (m_completed_token + 1 >= m_next_token)
+        return false;
+
+    Batch& batch = m_batches[(m_completed_token + 1) % UPLOAD_MANAGER_MAX_BATCHES];
+
+    if (block)
+        vkWaitForFences(m_vk_device, 1, &batch.vk_fence, VK_TRUE, UINT64_MAX);
+    else if (vkGetFenceStatus(m_vk_device, batch.vk_fence) != VK_SUCCESS)
+        return false;
+
+    m_ring_tail       = batch.ring_end;
+    m_completed_token = batch.token;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace vk
+} // namespace inferno
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "vk.h"
+#include "frame_allocator.h"
+#include <stdint.h>
+
+// Number of flushed batches that can be in flight on the transfer queue at once.
+#define UPLOAD_MANAGER_MAX_BATCHES 8
+// Minimum alignment of every staging allocation. Image uploads are additionally aligned to the texel block size of their format,
+// which is not a power of two for 3, 6, 12 and 24 byte texels, and to the device's optimal copy offset alignment.
+#define UPLOAD_MANAGER_ALIGNMENT 16
+
+namespace inferno
+{
+namespace vk
+{
+// Returned by UploadManager::flush(). Tokens increase monotonically, so a token is complete once every batch up to it is.
+using UploadToken = uint64_t;
+
+// Streams data into GPU_ONLY buffers and images through a persistently mapped staging ring. Uploads are recorded into one
+// command buffer per batch, and flush() submits that batch to the transfer queue without ever touching the graphics queue.
+//
+// If the transfer queue belongs to a different family than the graphics queue, every destination is released by the transfer
+// queue and has to be acquired on the graphics queue before use: call acquire() on a graphics command buffer once per frame and
+// make the submission of that command buffer wait on the semaphores it returns.
+//
+// Space in the ring is reclaimed as batches complete. An upload that doesn't fit into the free space waits for the oldest batch.
+// Not thread-safe.
+class UploadManager : public Object
+{
+public:
+    using Ptr = std::shared_ptr<UploadManager>;
+
+    static UploadManager::Ptr create(Backend::Ptr backend, size_t staging_size);
+
+    ~UploadManager();
+
+    // Copies 'size' bytes to 'dst' at 'dst_offset'. Uploads larger than half the ring are split up and may flush on the way.
+    void upload_buffer(Buffer* dst, size_t dst_offset, const void* data, size_t size);
+
+    // Replaces the contents of one mip level of one array layer of a color image, which is left in 'final_layout'.
+    // 'size' must cover the whole mip level; only that many bytes are staged.
+    void upload_image(Image* dst, const void* data, size_t size, uint32_t mip_level, uint32_t array_layer, VkImageLayout final_layout);
+
+    // Submits everything recorded since the last flush and returns the token of that batch. Returns the last token if nothing was
+    // recorded.
+    UploadToken flush();
+
+    bool is_complete(UploadToken token);
+    void wait(UploadToken token);
+
+    // Records the acquiring half of the queue family ownership transfers of all flushed batches that haven't been acquired yet.
+    // The submission of 'cmd' must wait on the returned semaphores at the returned stages. Does nothing if the transfer and
+    // graphics queues share a family.
+    void acquire(VkCommandBuffer cmd, FrameVector<VkSemaphore>& wait_semaphores, FrameVector<VkPipelineStageFlags>& wait_stages);
+
+private:
+    struct Batch
+    {
+        CommandBuffer::Ptr                 cmd;
+        VkFence                            vk_fence     = nullptr;
+        VkSemaphore                        vk_semaphore = nullptr;
+        UploadToken                        token        = 0;
+        uint64_t                           ring_end     = 0;
+        bool                               acquired     = true;
+        std::vector<VkBufferMemoryBarrier> buffer_barriers;
+        std::vector<VkImageMemoryBarrier>  image_barriers;
+    };
+
+    UploadManager(Backend::Ptr backend, size_t staging_size);
+    size_t allocate(size_t size, size_t alignment);
+    void   begin_batch();
+    bool   retire_oldest(bool block);
+
+private:
+    VkQueue          m_vk_transfer_queue;
+    uint32_t         m_transfer_family;
+    uint32_t         m_graphics_family;
+    bool             m_ownership_transfer;
+    CommandPool::Ptr m_command_pool;
+    Buffer::Ptr      m_staging;
+    uint8_t*         m_staging_ptr;
+    size_t           m_staging_size;
+    size_t           m_copy_alignment;
+    uint64_t         m_ring_head = 0;
+    uint64_t         m_ring_tail = 0;
+    Batch            m_batches[UPLOAD_MANAGER_MAX_BATCHES];
+    UploadToken      m_next_token      = 1;
+    UploadToken      m_completed_token = 0;
+    bool             m_recording       = false;
+};
+} // namespace vk
+} // namespace inferno
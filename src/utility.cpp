@@ -80,6 +80,14 @@ std::string executable_path()
 {
     if (g_exe_path == "")
     {
+        char    buffer[1024];
+        ssize_t length = readlink("/proc/self/exe", &buffer[0], sizeof(buffer) - 1);
+
+        if (length > 0)
+        {
+            buffer[length] = '\0';
+            g_exe_path     = path_without_file(buffer);
+        }
     }
 
     return g_exe_path;
@@ -166,6 +174,40 @@ bool read_text(std::string path, std::string& out)
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+bool read_binary(std::string path, std::vector<uint8_t>& out)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+
+    if (!file.is_open())
+        return false;
+
+    file.seekg(0, std::ios::end);
+    out.resize(size_t(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read((char*)out.data(), out.size());
+
+    return !file.fail();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool write_binary(std::string path, const void* data, size_t size)
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+        return false;
+
+    file.write((const char*)data, size);
+
+    // Buffered data is only written out on close, which can fail as well, e.g. when the disk is full.
+    file.close();
+
+    return !file.fail();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 template <typename T>
 bool contains(const std::vector<T>& vec, const T& obj)
 {
@@ -6,6 +6,7 @@
 #include <cassert>
 #include <algorithm>
 #include <stdio.h>
+#include <stdint.h>
 
 namespace inferno
 {
@@ -20,6 +21,12 @@ extern std::string executable_path();
 // Reads the contents of a text file into an std::string. Returns false if file does not exist.
 extern bool read_text(std::string path, std::string& out);
 
+// Reads the contents of a binary file. Returns false if the file does not exist or could not be read.
+extern bool read_binary(std::string path, std::vector<uint8_t>& out);
+
+// Writes 'size' bytes to a binary file, replacing any existing contents.
+extern bool write_binary(std::string path, const void* data, size_t size);
+
 // Reads the specified shader source.
 extern bool read_shader(const std::string& path, std::string& out, std::vector<std::string> defines = std::vector<std::string>());
 
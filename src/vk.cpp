@@ -1,6 +1,9 @@
 #include "vk.h"
+#include "frame_allocator.h"
 #include "logger.h"
 #include "macros.h"
+#include "utility.h"
+#include "fast_hash.h"
 
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
@@ -8,11 +11,34 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <atomic>
 
 namespace inferno
 {
 namespace vk
 {
+#define PIPELINE_CACHE_FILE_MAGIC 0x43504E49 // 'INPC'
+#define PIPELINE_CACHE_FILE_VERSION 1
+
+// Prepended to the driver's cache data. The driver validates its own header too, but doesn't know about driver updates that keep
+// the same UUID, so the vendor, device and driver version are checked here as well along with a hash of the data.
+struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint32_t driver_version;
+    uint8_t  uuid[VK_UUID_SIZE];
+    uint64_t data_size;
+    uint64_t data_hash;
+};
+
+static std::atomic<uint64_t> g_next_image_view_id(1);
+
+// Transient CPU memory handed out during a frame has to stay alive until that frame's context is reused.
+static_assert(MAX_FRAMES_IN_FLIGHT <= FRAME_ALLOCATOR_FRAME_COUNT, "The frame allocator must keep at least as many frames as can be in flight.");
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 const char* kDeviceExtensions[] = {
@@ -94,8 +120,8 @@ bool QueueInfos::transfer()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-Object::Object(Backend::Ptr backend, VkDevice device) :
-    m_vk_backend(backend)
+Object::Object(Backend::Ptr backend) :
+    m_vk_backend(backend), m_vk_device(backend->device())
 {
 }
 
@@ -172,13 +198,13 @@ Image::~Image()
 
 ImageView::Ptr ImageView::create(Backend::Ptr backend, Image::Ptr image, VkImageViewType view_type, VkImageAspectFlags aspect_flags, uint32_t base_mip_level, uint32_t level_count, uint32_t base_array_layer, uint32_t layer_count)
 {
-    return std::shared_ptr<ImageView>(new ImageView(backend, image, view_type, aspect_flags, base_mip_level, level_count, base_array_layer, layer_count));
+    return std::shared_ptr<ImageView>(new ImageView(backend, image.get(), view_type, aspect_flags, base_mip_level, level_count, base_array_layer, layer_count));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ImageView::ImageView(Backend::Ptr backend, Image::Ptr image, VkImageViewType view_type, VkImageAspectFlags aspect_flags, uint32_t base_mip_level, uint32_t level_count, uint32_t base_array_layer, uint32_t layer_count) :
-    Object(backend)
+ImageView::ImageView(Backend::Ptr backend, Image* image, VkImageViewType view_type, VkImageAspectFlags aspect_flags, uint32_t base_mip_level, uint32_t level_count, uint32_t base_array_layer, uint32_t layer_count) :
+    Object(backend), m_id(g_next_image_view_id.fetch_add(1, std::memory_order_relaxed))
 {
     VkImageViewCreateInfo info;
     INFERNO_ZERO_MEMORY(info);
@@ -204,27 +230,25 @@ ImageView::ImageView(Backend::Ptr backend, Image::Ptr image, VkImageViewType vie
 
 ImageView::~ImageView()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyImageView(backend->device(), m_vk_image_view, nullptr);
+    vkDestroyImageView(m_vk_device, m_vk_image_view, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-RenderPass::Ptr RenderPass::create(Backend::Ptr backend, std::vector<VkAttachmentDescription> attachment_descs, std::vector<VkSubpassDescription> subpass_descs, std::vector<VkSubpassDependency> subpass_deps)
+RenderPass::Ptr RenderPass::create(Backend::Ptr backend, const std::vector<VkAttachmentDescription>& attachment_descs, const std::vector<VkSubpassDescription>& subpass_descs, const std::vector<VkSubpassDependency>& subpass_deps)
 {
     return std::shared_ptr<RenderPass>(new RenderPass(backend, attachment_descs, subpass_descs, subpass_deps));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-RenderPass::RenderPass(Backend::Ptr backend, std::vector<VkAttachmentDescription> attachment_descs, std::vector<VkSubpassDescription> subpass_descs, std::vector<VkSubpassDependency> subpass_deps) :
+RenderPass::RenderPass(Backend::Ptr backend, const std::vector<VkAttachmentDescription>& attachment_descs, const std::vector<VkSubpassDescription>& subpass_descs, const std::vector<VkSubpassDependency>& subpass_deps) :
     Object(backend)
 {
     VkRenderPassCreateInfo render_pass_info;
@@ -243,36 +267,81 @@ RenderPass::RenderPass(Backend::Ptr backend, std::vector<VkAttachmentDescription
         INFERNO_LOG_FATAL("(Vulkan) Failed to create Render Pass.");
         throw std::runtime_error("(Vulkan) Failed to create Render Pass.");
     }
+
+    // References only contribute the format and sample count of the attachment they point to, which is what compatibility is
+    // defined by.
+    auto add_reference = [&](FieldHasher& h, const VkAttachmentReference& ref) {
+        if (ref.attachment == VK_ATTACHMENT_UNUSED)
+            h.add(VK_ATTACHMENT_UNUSED);
+        else
+            h.add(attachment_descs[ref.attachment].format).add(attachment_descs[ref.attachment].samples);
+    };
+
+    FieldHasher h;
+
+    h.add(uint32_t(attachment_descs.size())).add(uint32_t(subpass_descs.size())).add(uint32_t(subpass_deps.size()));
+
+    for (const auto& subpass : subpass_descs)
+    {
+        h.add(subpass.flags).add(subpass.pipelineBindPoint).add(subpass.inputAttachmentCount).add(subpass.colorAttachmentCount);
+
+        for (uint32_t i = 0; i < subpass.inputAttachmentCount; i++)
+            add_reference(h, subpass.pInputAttachments[i]);
+
+        for (uint32_t i = 0; i < subpass.colorAttachmentCount; i++)
+            add_reference(h, subpass.pColorAttachments[i]);
+
+        h.add(subpass.pResolveAttachments != nullptr);
+
+        if (subpass.pResolveAttachments)
+        {
+            for (uint32_t i = 0; i < subpass.colorAttachmentCount; i++)
+                add_reference(h, subpass.pResolveAttachments[i]);
+        }
+
+        h.add(subpass.pDepthStencilAttachment != nullptr);
+
+        if (subpass.pDepthStencilAttachment)
+            add_reference(h, *subpass.pDepthStencilAttachment);
+    }
+
+    for (const auto& dep : subpass_deps)
+        h.add(dep.srcSubpass).add(dep.dstSubpass).add(dep.srcStageMask).add(dep.dstStageMask).add(dep.srcAccessMask).add(dep.dstAccessMask).add(dep.dependencyFlags);
+
+    m_compatibility_hash = h.result();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 RenderPass::~RenderPass()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyRenderPass(backend->device(), m_vk_render_pass, nullptr);
+    vkDestroyRenderPass(m_vk_device, m_vk_render_pass, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-Framebuffer::Ptr Framebuffer::create(Backend::Ptr backend, RenderPass::Ptr render_pass, std::vector<ImageView::Ptr> views, uint32_t width, uint32_t height, uint32_t layers)
+Framebuffer::Ptr Framebuffer::create(Backend::Ptr backend, RenderPass::Ptr render_pass, const std::vector<ImageView::Ptr>& views, uint32_t width, uint32_t height, uint32_t layers)
 {
-    return std::shared_ptr<Framebuffer>(new Framebuffer(backend, render_pass, views, width, height, layers));
+    FrameVector<ImageView*> raw_views(views.size());
+
+    for (int i = 0; i < views.size(); i++)
+        raw_views[i] = views[i].get();
+
+    return std::shared_ptr<Framebuffer>(new Framebuffer(backend, render_pass.get(), raw_views.data(), uint32_t(raw_views.size()), width, height, layers));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-Framebuffer::Framebuffer(Backend::Ptr backend, RenderPass::Ptr render_pass, std::vector<ImageView::Ptr> views, uint32_t width, uint32_t height, uint32_t layers) :
+Framebuffer::Framebuffer(Backend::Ptr backend, RenderPass* render_pass, ImageView* const* views, uint32_t view_count, uint32_t width, uint32_t height, uint32_t layers) :
     Object(backend)
 {
-    std::vector<VkImageView> attachments(views.size());
+    FrameVector<VkImageView> attachments(view_count);
 
     for (int i = 0; i < attachments.size(); i++)
         attachments[i] = views[i]->handle();
@@ -283,7 +352,7 @@ Framebuffer::Framebuffer(Backend::Ptr backend, RenderPass::Ptr render_pass, std:
     frameBuffer_create_info.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
     frameBuffer_create_info.pNext           = NULL;
     frameBuffer_create_info.renderPass      = render_pass->handle();
-    frameBuffer_create_info.attachmentCount = views.size();
+    frameBuffer_create_info.attachmentCount = view_count;
     frameBuffer_create_info.pAttachments    = attachments.data();
     frameBuffer_create_info.width           = width;
     frameBuffer_create_info.height          = height;
@@ -300,15 +369,13 @@ Framebuffer::Framebuffer(Backend::Ptr backend, RenderPass::Ptr render_pass, std:
 
 Framebuffer::~Framebuffer()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyFramebuffer(backend->device(), m_vk_framebuffer, nullptr);
+    vkDestroyFramebuffer(m_vk_device, m_vk_framebuffer, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -377,6 +444,8 @@ Buffer::Buffer(Backend::Ptr backend, VkBufferUsageFlags usage, size_t size, VmaM
 
     m_vk_device_memory = vma_alloc_info.deviceMemory;
 
+    vmaGetMemoryTypeProperties(m_vma_allocator, vma_alloc_info.memoryType, &m_memory_properties);
+
     if (create_flags & VMA_ALLOCATION_CREATE_MAPPED_BIT)
         m_mapped_ptr = vma_alloc_info.pMappedData;
 }
@@ -418,15 +487,13 @@ CommandPool::CommandPool(Backend::Ptr backend, uint32_t queue_family_index) :
 
 CommandPool::~CommandPool()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyCommandPool(backend->device(), m_vk_pool, nullptr);
+    vkDestroyCommandPool(m_vk_device, m_vk_pool, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -462,16 +529,15 @@ CommandBuffer::Ptr CommandBuffer::create(Backend::Ptr backend, CommandPool::Ptr
 
 CommandBuffer::~CommandBuffer()
 {
-    if (m_vk_backend.expired() || m_vk_pool.expired())
+    if (backend_destroyed() || m_vk_pool.expired())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-    auto pool    = m_vk_pool.lock();
+    auto pool = m_vk_pool.lock();
 
-    vkFreeCommandBuffers(backend->device(), pool->handle(), 1, &m_vk_command_buffer);
+    vkFreeCommandBuffers(m_vk_device, pool->handle(), 1, &m_vk_command_buffer);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -483,45 +549,43 @@ void CommandBuffer::reset()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ShaderModule::Ptr ShaderModule::create(Backend::Ptr backend, std::vector<uint32_t> spirv)
+ShaderModule::Ptr ShaderModule::create(Backend::Ptr backend, const std::vector<uint32_t>& spirv)
 {
     return std::shared_ptr<ShaderModule>(new ShaderModule(backend, spirv));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ShaderModule::ShaderModule(Backend::Ptr backend, std::vector<uint32_t> spirv) :
+ShaderModule::ShaderModule(Backend::Ptr backend, const std::vector<uint32_t>& spirv) :
     Object(backend)
 {
     VkShaderModuleCreateInfo create_info;
     INFERNO_ZERO_MEMORY(create_info);
 
     create_info.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    create_info.codeSize = spirv.size();
-    create_info.pCode    = reinterpret_cast<const uint32_t*>(spirv.data());
+    create_info.codeSize = spirv.size() * sizeof(uint32_t);
+    create_info.pCode    = spirv.data();
 
-    VkShaderModule shader_module;
-
-    if (vkCreateShaderModule(backend->device(), &create_info, nullptr, &shader_module) != VK_SUCCESS)
+    if (vkCreateShaderModule(backend->device(), &create_info, nullptr, &m_vk_module) != VK_SUCCESS)
     {
         INFERNO_LOG_FATAL("(Vulkan) Failed to create shader module.");
         throw std::runtime_error("(Vulkan) Failed to create shader module.");
     }
+
+    m_hash = fast_hash(spirv.data(), create_info.codeSize);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 ShaderModule::~ShaderModule()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyShaderModule(backend->device(), m_vk_module, nullptr);
+    vkDestroyShaderModule(m_vk_device, m_vk_module, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1040,18 +1104,26 @@ GraphicsPipeline::Desc::Desc()
     {
         INFERNO_ZERO_MEMORY(shader_stages[i]);
         shader_stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shader_hashes[i]       = 0;
     }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::add_shader_stage(VkShaderStageFlagBits stage, ShaderModule::Ptr shader_module, std::string name)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::add_shader_stage(VkShaderStageFlagBits stage, ShaderModule::Ptr shader_module, const char* name)
+{
+    return add_shader_stage(stage, shader_module.get(), name);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::add_shader_stage(VkShaderStageFlagBits stage, ShaderModule* shader_module, const char* name)
 {
     uint32_t idx = shader_stage_count++;
 
     shader_entry_names[idx]   = name;
+    shader_hashes[idx]        = shader_module->hash();
     shader_stages[idx].module = shader_module->handle();
-    shader_stages[idx].pName  = shader_entry_names[idx].c_str();
     shader_stages[idx].stage  = stage;
 
     return *this;
@@ -1059,55 +1131,77 @@ GraphicsPipeline::Desc& GraphicsPipeline::Desc::add_shader_stage(VkShaderStageFl
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_input_assembly_state(InputAssemblyStateDesc state)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_vertex_input_state(const VertexInputStateDesc& state)
+{
+    vertex_input_state            = state;
+    create_info.pVertexInputState = &vertex_input_state.create_info;
+    return *this;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_input_assembly_state(const InputAssemblyStateDesc& state)
 {
-    create_info.pInputAssemblyState = &state.create_info;
+    input_assembly_state            = state;
+    create_info.pInputAssemblyState = &input_assembly_state.create_info;
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_tessellation_state(TessellationStateDesc state)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_tessellation_state(const TessellationStateDesc& state)
 {
-    create_info.pTessellationState = &state.create_info;
+    tessellation_state             = state;
+    create_info.pTessellationState = &tessellation_state.create_info;
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_rasterization_state(RasterizationStateDesc state)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_rasterization_state(const RasterizationStateDesc& state)
 {
-    create_info.pRasterizationState = &state.create_info;
+    rasterization_state             = state;
+    create_info.pRasterizationState = &rasterization_state.create_info;
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_multisample_state(MultisampleStateDesc state)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_multisample_state(const MultisampleStateDesc& state)
 {
-    create_info.pMultisampleState = &state.create_info;
+    multisample_state             = state;
+    create_info.pMultisampleState = &multisample_state.create_info;
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_depth_stencil_state(DepthStencilStateDesc state)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_depth_stencil_state(const DepthStencilStateDesc& state)
 {
-    create_info.pDepthStencilState = &state.create_info;
+    depth_stencil_state            = state;
+    create_info.pDepthStencilState = &depth_stencil_state.create_info;
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_color_blend_state(ColorBlendStateDesc state)
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_color_blend_state(const ColorBlendStateDesc& state)
 {
-    create_info.pColorBlendState = &state.create_info;
+    color_blend_state            = state;
+    create_info.pColorBlendState = &color_blend_state.create_info;
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_pipeline_layout(std::shared_ptr<PipelineLayout> layout)
+{
+    return set_pipeline_layout(layout.get());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_pipeline_layout(PipelineLayout* layout)
 {
     create_info.layout = layout->handle();
     return *this;
@@ -1116,8 +1210,16 @@ GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_pipeline_layout(std::shared_
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_render_pass(RenderPass::Ptr render_pass)
+{
+    return set_render_pass(render_pass.get());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_render_pass(RenderPass* render_pass)
 {
     create_info.renderPass = render_pass->handle();
+    render_pass_hash       = render_pass->compatibility_hash();
     return *this;
 }
 
@@ -1147,17 +1249,66 @@ GraphicsPipeline::Desc& GraphicsPipeline::Desc::set_base_pipeline_index(int32_t
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::Ptr GraphicsPipeline::create(Backend::Ptr backend, Desc desc)
+GraphicsPipeline::Ptr GraphicsPipeline::create(Backend::Ptr backend, const Desc& desc)
 {
     return std::shared_ptr<GraphicsPipeline>(new GraphicsPipeline(backend, desc));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-GraphicsPipeline::GraphicsPipeline(Backend::Ptr backend, Desc desc) :
+GraphicsPipeline::GraphicsPipeline(Backend::Ptr backend, const Desc& desc) :
     Object(backend)
 {
-    if (vkCreateGraphicsPipelines(backend->device(), nullptr, 1, &desc.create_info, nullptr, &m_vk_pipeline) != VK_SUCCESS)
+    // The Desc may have been copied since it was filled in, so every pointer into it is resolved against this copy.
+    VkGraphicsPipelineCreateInfo           create_info = desc.create_info;
+    VkPipelineShaderStageCreateInfo        shader_stages[6];
+    VkPipelineVertexInputStateCreateInfo   vertex_input_state  = desc.vertex_input_state.create_info;
+    VkPipelineRasterizationStateCreateInfo rasterization_state = desc.rasterization_state.create_info;
+    VkPipelineColorBlendStateCreateInfo    color_blend_state   = desc.color_blend_state.create_info;
+
+    for (uint32_t i = 0; i < desc.shader_stage_count; i++)
+    {
+        shader_stages[i]       = desc.shader_stages[i];
+        shader_stages[i].pName = desc.shader_entry_names[i].c_str();
+    }
+
+    create_info.stageCount = desc.shader_stage_count;
+    create_info.pStages    = &shader_stages[0];
+
+    if (create_info.pVertexInputState)
+    {
+        vertex_input_state.pVertexBindingDescriptions   = &desc.vertex_input_state.binding_desc[0];
+        vertex_input_state.pVertexAttributeDescriptions = &desc.vertex_input_state.attribute_desc[0];
+        create_info.pVertexInputState                   = &vertex_input_state;
+    }
+
+    if (create_info.pRasterizationState)
+    {
+        if (rasterization_state.pNext)
+            rasterization_state.pNext = &desc.rasterization_state.conservative_raster_create_info;
+
+        create_info.pRasterizationState = &rasterization_state;
+    }
+
+    if (create_info.pColorBlendState)
+    {
+        color_blend_state.pAttachments = &desc.color_blend_state.attachments[0];
+        create_info.pColorBlendState   = &color_blend_state;
+    }
+
+    if (create_info.pInputAssemblyState)
+        create_info.pInputAssemblyState = &desc.input_assembly_state.create_info;
+
+    if (create_info.pTessellationState)
+        create_info.pTessellationState = &desc.tessellation_state.create_info;
+
+    if (create_info.pMultisampleState)
+        create_info.pMultisampleState = &desc.multisample_state.create_info;
+
+    if (create_info.pDepthStencilState)
+        create_info.pDepthStencilState = &desc.depth_stencil_state.create_info;
+
+    if (vkCreateGraphicsPipelines(backend->device(), backend->pipeline_cache(), 1, &create_info, nullptr, &m_vk_pipeline) != VK_SUCCESS)
     {
         INFERNO_LOG_FATAL("(Vulkan) Failed to create Graphics Pipeline.");
         throw std::runtime_error("(Vulkan) Failed to create Graphics Pipeline.");
@@ -1168,15 +1319,13 @@ GraphicsPipeline::GraphicsPipeline(Backend::Ptr backend, Desc desc) :
 
 GraphicsPipeline::~GraphicsPipeline()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyPipeline(backend->device(), m_vk_pipeline, nullptr);
+    vkDestroyPipeline(m_vk_device, m_vk_pipeline, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1191,10 +1340,17 @@ ComputePipeline::Desc::Desc()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ComputePipeline::Desc& ComputePipeline::Desc::set_shader_stage(ShaderModule::Ptr shader_module, std::string name)
+ComputePipeline::Desc& ComputePipeline::Desc::set_shader_stage(ShaderModule::Ptr shader_module, const char* name)
+{
+    return set_shader_stage(shader_module.get(), name);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+ComputePipeline::Desc& ComputePipeline::Desc::set_shader_stage(ShaderModule* shader_module, const char* name)
 {
     shader_entry_name        = name;
-    create_info.stage.pName  = shader_entry_name.c_str();
+    shader_hash              = shader_module->hash();
     create_info.stage.module = shader_module->handle();
     create_info.stage.stage  = VK_SHADER_STAGE_COMPUTE_BIT;
 
@@ -1204,6 +1360,13 @@ ComputePipeline::Desc& ComputePipeline::Desc::set_shader_stage(ShaderModule::Ptr
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 ComputePipeline::Desc& ComputePipeline::Desc::set_pipeline_layout(std::shared_ptr<PipelineLayout> layout)
+{
+    return set_pipeline_layout(layout.get());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+ComputePipeline::Desc& ComputePipeline::Desc::set_pipeline_layout(PipelineLayout* layout)
 {
     create_info.layout = layout->handle();
     return *this;
@@ -1227,17 +1390,21 @@ ComputePipeline::Desc& ComputePipeline::Desc::set_base_pipeline_index(int32_t in
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ComputePipeline::Ptr ComputePipeline::create(Backend::Ptr backend, Desc desc)
+ComputePipeline::Ptr ComputePipeline::create(Backend::Ptr backend, const Desc& desc)
 {
     return std::shared_ptr<ComputePipeline>(new ComputePipeline(backend, desc));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ComputePipeline::ComputePipeline(Backend::Ptr backend, Desc desc) :
+ComputePipeline::ComputePipeline(Backend::Ptr backend, const Desc& desc) :
     Object(backend)
 {
-    if (vkCreateComputePipelines(backend->device(), nullptr, 1, &desc.create_info, nullptr, &m_vk_pipeline) != VK_SUCCESS)
+    VkComputePipelineCreateInfo create_info = desc.create_info;
+
+    create_info.stage.pName = desc.shader_entry_name.c_str();
+
+    if (vkCreateComputePipelines(backend->device(), backend->pipeline_cache(), 1, &create_info, nullptr, &m_vk_pipeline) != VK_SUCCESS)
     {
         INFERNO_LOG_FATAL("(Vulkan) Failed to create Compute Pipeline.");
         throw std::runtime_error("(Vulkan) Failed to create Compute Pipeline.");
@@ -1248,26 +1415,24 @@ ComputePipeline::ComputePipeline(Backend::Ptr backend, Desc desc) :
 
 ComputePipeline::~ComputePipeline()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyPipeline(backend->device(), m_vk_pipeline, nullptr);
+    vkDestroyPipeline(m_vk_device, m_vk_pipeline, nullptr);
 }
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-Sampler::Ptr Sampler::create(Backend::Ptr backend, Desc desc)
+Sampler::Ptr Sampler::create(Backend::Ptr backend, const Desc& desc)
 {
     return std::shared_ptr<Sampler>(new Sampler(backend, desc));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-Sampler::Sampler(Backend::Ptr backend, Desc desc) :
+Sampler::Sampler(Backend::Ptr backend, const Desc& desc) :
     Object(backend)
 {
     VkSamplerCreateInfo info;
@@ -1302,15 +1467,21 @@ Sampler::Sampler(Backend::Ptr backend, Desc desc) :
 
 Sampler::~Sampler()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
+    vkDestroySampler(m_vk_device, m_vk_sampler, nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
 
-    vkDestroySampler(backend->device(), m_vk_sampler, nullptr);
+DescriptorSetLayout::Desc& DescriptorSetLayout::Desc::set_flags(VkDescriptorSetLayoutCreateFlags value)
+{
+    flags = value;
+    return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1318,6 +1489,7 @@ Sampler::~Sampler()
 DescriptorSetLayout::Desc& DescriptorSetLayout::Desc::add_binding(uint32_t binding, VkDescriptorType descriptor_type, uint32_t descriptor_count, VkShaderStageFlags stage_flags)
 {
     bindings.push_back({ binding, descriptor_type, descriptor_count, stage_flags, nullptr });
+    binding_flags.push_back(0);
     return *this;
 }
 
@@ -1328,28 +1500,67 @@ DescriptorSetLayout::Desc& DescriptorSetLayout::Desc::add_binding(uint32_t bindi
     for (int i = 0; i < descriptor_count; i++)
         binding_samplers[binding][i] = samplers[i]->handle();
 
+    // Only marks the binding as having immutable samplers, the pointer is resolved when the layout is created.
     bindings.push_back({ binding, descriptor_type, descriptor_count, stage_flags, &binding_samplers[binding][0] });
+    binding_flags.push_back(0);
     return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-DescriptorSetLayout::Ptr DescriptorSetLayout::create(Backend::Ptr backend, Desc desc)
+DescriptorSetLayout::Desc& DescriptorSetLayout::Desc::set_binding_flags(uint32_t binding, VkDescriptorBindingFlagsEXT value)
+{
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        if (bindings[i].binding == binding)
+            binding_flags[i] = value;
+    }
+
+    return *this;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+DescriptorSetLayout::Ptr DescriptorSetLayout::create(Backend::Ptr backend, const Desc& desc)
 {
     return std::shared_ptr<DescriptorSetLayout>(new DescriptorSetLayout(backend, desc));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-DescriptorSetLayout::DescriptorSetLayout(Backend::Ptr backend, Desc desc) :
+DescriptorSetLayout::DescriptorSetLayout(Backend::Ptr backend, const Desc& desc) :
     Object(backend)
 {
+    SmallVector<VkDescriptorSetLayoutBinding, MAX_DESCRIPTOR_SET_LAYOUT_BINDINGS> bindings = desc.bindings;
+
+    for (auto& binding : bindings)
+    {
+        if (binding.pImmutableSamplers)
+            binding.pImmutableSamplers = &desc.binding_samplers[binding.binding][0];
+    }
+
     VkDescriptorSetLayoutCreateInfo layout_info;
     INFERNO_ZERO_MEMORY(layout_info);
 
     layout_info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layout_info.bindingCount = desc.bindings.size();
-    layout_info.pBindings    = desc.bindings.data();
+    layout_info.flags        = desc.flags;
+    layout_info.bindingCount = bindings.size();
+    layout_info.pBindings    = bindings.data();
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT flags_info;
+    INFERNO_ZERO_MEMORY(flags_info);
+
+    for (auto flags : desc.binding_flags)
+    {
+        if (flags)
+        {
+            flags_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+            flags_info.bindingCount  = desc.binding_flags.size();
+            flags_info.pBindingFlags = desc.binding_flags.data();
+            layout_info.pNext        = &flags_info;
+            break;
+        }
+    }
 
     if (vkCreateDescriptorSetLayout(backend->device(), &layout_info, nullptr, &m_vk_ds_layout) != VK_SUCCESS)
     {
@@ -1362,22 +1573,27 @@ DescriptorSetLayout::DescriptorSetLayout(Backend::Ptr backend, Desc desc) :
 
 DescriptorSetLayout::~DescriptorSetLayout()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyDescriptorSetLayout(backend->device(), m_vk_ds_layout, nullptr);
+    vkDestroyDescriptorSetLayout(m_vk_device, m_vk_ds_layout, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 PipelineLayout::Desc& PipelineLayout::Desc::add_descriptor_set_layout(DescriptorSetLayout::Ptr layout)
 {
-    layouts.push_back(layout);
+    return add_descriptor_set_layout(layout.get());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+PipelineLayout::Desc& PipelineLayout::Desc::add_descriptor_set_layout(DescriptorSetLayout* layout)
+{
+    layouts.push_back(layout->handle());
     return *this;
 }
 
@@ -1391,21 +1607,16 @@ PipelineLayout::Desc& PipelineLayout::Desc::add_push_constant_range(VkShaderStag
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-PipelineLayout::Ptr PipelineLayout::create(Backend::Ptr backend, Desc desc)
+PipelineLayout::Ptr PipelineLayout::create(Backend::Ptr backend, const Desc& desc)
 {
     return std::shared_ptr<PipelineLayout>(new PipelineLayout(backend, desc));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-PipelineLayout::PipelineLayout(Backend::Ptr backend, Desc desc) :
+PipelineLayout::PipelineLayout(Backend::Ptr backend, const Desc& desc) :
     Object(backend)
 {
-    std::vector<VkDescriptorSetLayout> vk_layouts(desc.layouts.size());
-
-    for (uint32_t i = 0; i < desc.layouts.size(); i++)
-        vk_layouts[i] = desc.layouts[i]->handle();
-
     VkPipelineLayoutCreateInfo info;
     INFERNO_ZERO_MEMORY(info);
 
@@ -1413,7 +1624,7 @@ PipelineLayout::PipelineLayout(Backend::Ptr backend, Desc desc) :
     info.pushConstantRangeCount = desc.push_constant_ranges.size();
     info.pPushConstantRanges    = desc.push_constant_ranges.data();
     info.setLayoutCount         = desc.layouts.size();
-    info.pSetLayouts            = vk_layouts.data();
+    info.pSetLayouts            = desc.layouts.data();
 
     if (vkCreatePipelineLayout(backend->device(), &info, nullptr, &m_vk_pipeline_layout) != VK_SUCCESS)
     {
@@ -1426,15 +1637,21 @@ PipelineLayout::PipelineLayout(Backend::Ptr backend, Desc desc) :
 
 PipelineLayout::~PipelineLayout()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
+    vkDestroyPipelineLayout(m_vk_device, m_vk_pipeline_layout, nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
 
-    vkDestroyPipelineLayout(backend->device(), m_vk_pipeline_layout, nullptr);
+DescriptorPool::Desc& DescriptorPool::Desc::set_flags(VkDescriptorPoolCreateFlags value)
+{
+    flags = value;
+    return *this;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1455,20 +1672,22 @@ DescriptorPool::Desc& DescriptorPool::Desc::add_pool_size(VkDescriptorType type,
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-DescriptorPool::Ptr DescriptorPool::create(Backend::Ptr backend, Desc desc)
+DescriptorPool::Ptr DescriptorPool::create(Backend::Ptr backend, const Desc& desc)
 {
     return std::shared_ptr<DescriptorPool>(new DescriptorPool(backend, desc));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-DescriptorPool::DescriptorPool(Backend::Ptr backend, Desc desc) :
+DescriptorPool::DescriptorPool(Backend::Ptr backend, const Desc& desc) :
     Object(backend)
 {
     VkDescriptorPoolCreateInfo pool_info;
     INFERNO_ZERO_MEMORY(pool_info);
 
+    // DescriptorSet frees itself individually, which the pool has to allow.
     pool_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags         = desc.flags | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
     pool_info.poolSizeCount = static_cast<uint32_t>(desc.pool_sizes.size());
     pool_info.pPoolSizes    = desc.pool_sizes.data();
     pool_info.maxSets       = desc.max_sets;
@@ -1484,15 +1703,13 @@ DescriptorPool::DescriptorPool(Backend::Ptr backend, Desc desc) :
 
 DescriptorPool::~DescriptorPool()
 {
-    if (m_vk_backend.expired())
+    if (backend_destroyed())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-
-    vkDestroyDescriptorPool(backend->device(), m_vk_ds_pool, nullptr);
+    vkDestroyDescriptorPool(m_vk_device, m_vk_ds_pool, nullptr);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1530,25 +1747,46 @@ DescriptorSet::DescriptorSet(Backend::Ptr backend, DescriptorSetLayout::Ptr layo
 
 DescriptorSet::~DescriptorSet()
 {
-    if (m_vk_backend.expired() || m_vk_pool.expired())
+    if (backend_destroyed() || m_vk_pool.expired())
     {
         INFERNO_LOG_FATAL("(Vulkan) Destructing after Device.");
         throw std::runtime_error("(Vulkan) Destructing after Device.");
     }
 
-    auto backend = m_vk_backend.lock();
-    auto pool    = m_vk_pool.lock();
+    auto pool = m_vk_pool.lock();
 
-    vkFreeDescriptorSets(backend->device(), pool->handle(), 1, &m_vk_ds);
+    vkFreeDescriptorSets(m_vk_device, pool->handle(), 1, &m_vk_ds);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-Backend::Ptr Backend::create(GLFWwindow* window, bool enable_validation_layers)
+Resources::Ptr Resources::create(Backend::Ptr backend)
+{
+    return std::shared_ptr<Resources>(new Resources(backend));
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Resources::Resources(Backend::Ptr backend) :
+    m_backend(backend)
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Resources::~Resources()
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Backend::Ptr Backend::create(GLFWwindow* window, bool enable_validation_layers, uint32_t frames_in_flight)
 {
     Backend*                 backend        = new Backend(window, enable_validation_layers);
     std::shared_ptr<Backend> backend_shared = std::shared_ptr<Backend>(backend);
+    backend->m_self                         = backend_shared;
     backend->create_swapchain(backend_shared);
+    backend->create_frame_contexts(frames_in_flight);
 
     return backend_shared;
 }
@@ -1566,7 +1804,7 @@ Backend::Backend(GLFWwindow* window, bool enable_validation_layers) :
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName        = "Inferno";
     appInfo.engineVersion      = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion         = VK_API_VERSION_1_0;
+    appInfo.apiVersion         = VK_API_VERSION_1_1;
 
     std::vector<const char*> extensions = required_extensions(enable_validation_layers);
 
@@ -1635,12 +1873,30 @@ Backend::Backend(GLFWwindow* window, bool enable_validation_layers) :
         INFERNO_LOG_FATAL("(Vulkan) Failed to create Allocator.");
         throw std::runtime_error("(Vulkan) Failed to create Allocator.");
     }
+
+    create_pipeline_cache();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 Backend::~Backend()
 {
+    wait_idle();
+
+    for (uint32_t i = 0; i < m_frames_in_flight; i++)
+    {
+        vkDestroyCommandPool(m_vk_device, m_frames[i].vk_command_pool, nullptr);
+        vkDestroySemaphore(m_vk_device, m_frames[i].vk_image_available, nullptr);
+        vkDestroySemaphore(m_vk_device, m_frames[i].vk_render_finished, nullptr);
+        vkDestroyFence(m_vk_device, m_frames[i].vk_fence, nullptr);
+    }
+
+    if (m_vk_pipeline_cache)
+    {
+        save_pipeline_cache();
+        vkDestroyPipelineCache(m_vk_device, m_vk_pipeline_cache, nullptr);
+    }
+
     for (int i = 0; i < m_swap_chain_images.size(); i++)
     {
         m_swap_chain_framebuffers[i].reset();
@@ -1661,6 +1917,151 @@ Backend::~Backend()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+FrameContext& Backend::begin_frame()
+{
+    FrameContext& frame = m_frames[m_frame_number % m_frames_in_flight];
+
+    // Only blocks if the GPU hasn't finished the frame that used this context frames_in_flight frames ago.
+    vkWaitForFences(m_vk_device, 1, &frame.vk_fence, VK_TRUE, UINT64_MAX);
+
+    VkResult result = vkAcquireNextImageKHR(m_vk_device, m_vk_swap_chain, UINT64_MAX, frame.vk_image_available, VK_NULL_HANDLE, &frame.image_index);
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        recreate_swapchain();
+        result = vkAcquireNextImageKHR(m_vk_device, m_vk_swap_chain, UINT64_MAX, frame.vk_image_available, VK_NULL_HANDLE, &frame.image_index);
+    }
+
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to acquire Swap Chain image.");
+        throw std::runtime_error("(Vulkan) Failed to acquire Swap Chain image.");
+    }
+
+    // Images can come back out of order, so the frame that last rendered to this one may not be the one that used this context.
+    VkFence& image_fence = m_image_fences[frame.image_index];
+
+    if (image_fence && image_fence != frame.vk_fence)
+        vkWaitForFences(m_vk_device, 1, &image_fence, VK_TRUE, UINT64_MAX);
+
+    image_fence = frame.vk_fence;
+
+    vkResetFences(m_vk_device, 1, &frame.vk_fence);
+    vkResetCommandPool(m_vk_device, frame.vk_command_pool, 0);
+
+    VkCommandBufferBeginInfo begin_info;
+    INFERNO_ZERO_MEMORY(begin_info);
+
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(frame.vk_command_buffer, &begin_info) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to begin Command Buffer.");
+        throw std::runtime_error("(Vulkan) Failed to begin Command Buffer.");
+    }
+
+    frame.frame_number = m_frame_number;
+
+    return frame;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Backend::end_frame(uint32_t wait_count, const VkSemaphore* wait_semaphores, const VkPipelineStageFlags* wait_stages)
+{
+    FrameContext& frame = m_frames[m_frame_number % m_frames_in_flight];
+
+    if (vkEndCommandBuffer(frame.vk_command_buffer) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to end Command Buffer.");
+        throw std::runtime_error("(Vulkan) Failed to end Command Buffer.");
+    }
+
+    FrameVector<VkSemaphore>          semaphores(wait_semaphores, wait_semaphores + wait_count);
+    FrameVector<VkPipelineStageFlags> stages(wait_stages, wait_stages + wait_count);
+
+    semaphores.push_back(frame.vk_image_available);
+    stages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+    VkSubmitInfo submit_info;
+    INFERNO_ZERO_MEMORY(submit_info);
+
+    submit_info.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.waitSemaphoreCount   = uint32_t(semaphores.size());
+    submit_info.pWaitSemaphores      = semaphores.data();
+    submit_info.pWaitDstStageMask    = stages.data();
+    submit_info.commandBufferCount   = 1;
+    submit_info.pCommandBuffers      = &frame.vk_command_buffer;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores    = &frame.vk_render_finished;
+
+    if (vkQueueSubmit(m_vk_graphics_queue, 1, &submit_info, frame.vk_fence) != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to submit frame.");
+        throw std::runtime_error("(Vulkan) Failed to submit frame.");
+    }
+
+    VkPresentInfoKHR present_info;
+    INFERNO_ZERO_MEMORY(present_info);
+
+    present_info.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    present_info.waitSemaphoreCount = 1;
+    present_info.pWaitSemaphores    = &frame.vk_render_finished;
+    present_info.swapchainCount     = 1;
+    present_info.pSwapchains        = &m_vk_swap_chain;
+    present_info.pImageIndices      = &frame.image_index;
+
+    VkResult result = vkQueuePresentKHR(m_vk_presentation_queue, &present_info);
+
+    m_frame_number++;
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+        recreate_swapchain();
+    else if (result != VK_SUCCESS)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to present Swap Chain image.");
+        throw std::runtime_error("(Vulkan) Failed to present Swap Chain image.");
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Backend::wait_idle()
+{
+    vkDeviceWaitIdle(m_vk_device);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Framebuffer::Ptr Backend::swap_chain_framebuffer(uint32_t image_index)
+{
+    return m_swap_chain_framebuffers[image_index];
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+RenderPass::Ptr Backend::swap_chain_render_pass()
+{
+    return m_swap_chain_render_pass;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkExtent2D Backend::swap_chain_extent()
+{
+    return m_swap_chain_extent;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t Backend::frames_in_flight()
+{
+    return m_frames_in_flight;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 VkDevice Backend::device()
 {
     return m_vk_device;
@@ -1675,6 +2076,55 @@ VmaAllocator_T* Backend::allocator()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+VkQueue Backend::graphics_queue()
+{
+    return m_vk_graphics_queue;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkQueue Backend::compute_queue()
+{
+    return m_vk_compute_queue;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkQueue Backend::transfer_queue()
+{
+    return m_vk_transfer_queue;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+QueueInfos& Backend::queue_infos()
+{
+    return m_selected_queues;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkPhysicalDevice Backend::physical_device()
+{
+    return m_vk_physical_device;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+VkPipelineCache Backend::pipeline_cache()
+{
+    return m_vk_pipeline_cache;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Backend::descriptor_indexing()
+{
+    return m_descriptor_indexing;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 VkFormat Backend::find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
 {
     for (VkFormat format : candidates)
@@ -2115,15 +2565,29 @@ bool Backend::create_logical_device()
     VkPhysicalDeviceFeatures features;
     INFERNO_ZERO_MEMORY(features);
 
+    std::vector<const char*> extensions(std::begin(kDeviceExtensions), std::end(kDeviceExtensions));
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexing_features;
+    INFERNO_ZERO_MEMORY(indexing_features);
+
+    m_descriptor_indexing = check_descriptor_indexing_support(indexing_features);
+
+    if (m_descriptor_indexing)
+    {
+        extensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo device_info;
     INFERNO_ZERO_MEMORY(device_info);
 
     device_info.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    device_info.pNext                   = m_descriptor_indexing ? &indexing_features : nullptr;
     device_info.pQueueCreateInfos       = &m_selected_queues.infos[0];
     device_info.queueCreateInfoCount    = static_cast<uint32_t>(m_selected_queues.queue_count);
     device_info.pEnabledFeatures        = &features;
-    device_info.enabledExtensionCount   = sizeof(kDeviceExtensions) / sizeof(const char*);
-    device_info.ppEnabledExtensionNames = &kDeviceExtensions[0];
+    device_info.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
+    device_info.ppEnabledExtensionNames = extensions.data();
 
     if (m_vk_debug_messenger)
     {
@@ -2164,7 +2628,7 @@ bool Backend::create_logical_device()
     else if (m_selected_queues.transfer_queue_index == m_selected_queues.graphics_queue_index)
         m_vk_transfer_queue = m_vk_graphics_queue;
     else if (m_selected_queues.transfer_queue_index == m_selected_queues.compute_queue_index)
-        m_vk_transfer_queue = m_vk_transfer_queue;
+        m_vk_transfer_queue = m_vk_compute_queue;
     else
         vkGetDeviceQueue(m_vk_device, m_selected_queues.transfer_queue_index, 0, &m_vk_transfer_queue);
 
@@ -2173,6 +2637,52 @@ bool Backend::create_logical_device()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+bool Backend::check_descriptor_indexing_support(VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features)
+{
+    uint32_t extension_count;
+    vkEnumerateDeviceExtensionProperties(m_vk_physical_device, nullptr, &extension_count, nullptr);
+
+    std::vector<VkExtensionProperties> available_extensions(extension_count);
+    vkEnumerateDeviceExtensionProperties(m_vk_physical_device, nullptr, &extension_count, &available_extensions[0]);
+
+    int found = 0;
+
+    for (const auto& extension : available_extensions)
+    {
+        if (strcmp(extension.extensionName, VK_KHR_MAINTENANCE3_EXTENSION_NAME) == 0 || strcmp(extension.extensionName, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0)
+            found++;
+    }
+
+    if (found != 2)
+        return false;
+
+    INFERNO_ZERO_MEMORY(features);
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    VkPhysicalDeviceFeatures2 features2;
+    INFERNO_ZERO_MEMORY(features2);
+
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &features;
+
+    vkGetPhysicalDeviceFeatures2(m_vk_physical_device, &features2);
+
+    // Everything bindless resource arrays rely on. The remaining features stay enabled as reported, which is harmless.
+    bool supported = features.shaderSampledImageArrayNonUniformIndexing && features.shaderStorageBufferArrayNonUniformIndexing && features.runtimeDescriptorArray && features.descriptorBindingPartiallyBound && features.descriptorBindingSampledImageUpdateAfterBind && features.descriptorBindingStorageBufferUpdateAfterBind && features.descriptorBindingUpdateUnusedWhilePending;
+
+    if (!supported)
+    {
+        INFERNO_LOG_WARNING("(Vulkan) Descriptor indexing is missing required features, bindless resources are unavailable.");
+        return false;
+    }
+
+    features.pNext = nullptr;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 bool Backend::create_swapchain(std::shared_ptr<Backend> backend)
 {
     VkSurfaceFormatKHR surface_format = choose_swap_surface_format(m_swapchain_details.format);
@@ -2271,6 +2781,225 @@ bool Backend::create_swapchain(std::shared_ptr<Backend> backend)
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+void Backend::destroy_swapchain()
+{
+    for (int i = 0; i < m_swap_chain_images.size(); i++)
+    {
+        m_swap_chain_framebuffers[i].reset();
+        m_swap_chain_image_views[i].reset();
+        m_swap_chain_images[i].reset();
+    }
+
+    m_swap_chain_render_pass.reset();
+    m_swap_chain_depth_view.reset();
+    m_swap_chain_depth.reset();
+
+    vkDestroySwapchainKHR(m_vk_device, m_vk_swap_chain, nullptr);
+    m_vk_swap_chain = nullptr;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Backend::recreate_swapchain()
+{
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(m_window, &width, &height);
+
+    // A minimized window has no surface area to render to.
+    while (width == 0 || height == 0)
+    {
+        glfwWaitEvents();
+        glfwGetFramebufferSize(m_window, &width, &height);
+    }
+
+    wait_idle();
+    destroy_swapchain();
+    query_swap_chain_support(m_vk_physical_device, m_swapchain_details);
+
+    if (!create_swapchain(m_self.lock()))
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Failed to recreate Swap Chain.");
+        throw std::runtime_error("(Vulkan) Failed to recreate Swap Chain.");
+    }
+
+    m_image_fences.assign(m_swap_chain_images.size(), nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Backend::create_frame_contexts(uint32_t frames_in_flight)
+{
+    if (frames_in_flight == 0 || frames_in_flight > MAX_FRAMES_IN_FLIGHT)
+    {
+        INFERNO_LOG_FATAL("(Vulkan) Unsupported number of frames in flight.");
+        throw std::runtime_error("(Vulkan) Unsupported number of frames in flight.");
+    }
+
+    m_frames_in_flight = frames_in_flight;
+    m_image_fences.assign(m_swap_chain_images.size(), nullptr);
+
+    VkFenceCreateInfo fence_info;
+    INFERNO_ZERO_MEMORY(fence_info);
+
+    // Created signalled so the first wait of every context returns immediately.
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkSemaphoreCreateInfo semaphore_info;
+    INFERNO_ZERO_MEMORY(semaphore_info);
+
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    VkCommandPoolCreateInfo pool_info;
+    INFERNO_ZERO_MEMORY(pool_info);
+
+    // Command buffers are never reset individually, the whole pool is reset at the start of the frame.
+    pool_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = m_selected_queues.graphics_queue_index;
+
+    for (uint32_t i = 0; i < frames_in_flight; i++)
+    {
+        FrameContext& frame = m_frames[i];
+
+        if (vkCreateFence(m_vk_device, &fence_info, nullptr, &frame.vk_fence) != VK_SUCCESS || vkCreateSemaphore(m_vk_device, &semaphore_info, nullptr, &frame.vk_image_available) != VK_SUCCESS || vkCreateSemaphore(m_vk_device, &semaphore_info, nullptr, &frame.vk_render_finished) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create frame synchronization objects.");
+            throw std::runtime_error("(Vulkan) Failed to create frame synchronization objects.");
+        }
+
+        if (vkCreateCommandPool(m_vk_device, &pool_info, nullptr, &frame.vk_command_pool) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to create Command Pool.");
+            throw std::runtime_error("(Vulkan) Failed to create Command Pool.");
+        }
+
+        VkCommandBufferAllocateInfo alloc_info;
+        INFERNO_ZERO_MEMORY(alloc_info);
+
+        alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.commandPool        = frame.vk_command_pool;
+        alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(m_vk_device, &alloc_info, &frame.vk_command_buffer) != VK_SUCCESS)
+        {
+            INFERNO_LOG_FATAL("(Vulkan) Failed to allocate Command Buffer.");
+            throw std::runtime_error("(Vulkan) Failed to allocate Command Buffer.");
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Backend::create_pipeline_cache()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_vk_physical_device, &properties);
+
+    std::vector<uint8_t> file;
+    const uint8_t*       initial_data      = nullptr;
+    size_t               initial_data_size = 0;
+
+    if (utility::read_binary(utility::path_for_resource(PIPELINE_CACHE_FILE), file) && file.size() >= sizeof(PipelineCacheFileHeader) + sizeof(VkPipelineCacheHeaderVersionOne))
+    {
+        PipelineCacheFileHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+
+        VkPipelineCacheHeaderVersionOne driver_header;
+        memcpy(&driver_header, file.data() + sizeof(header), sizeof(driver_header));
+
+        const uint8_t* data = file.data() + sizeof(header);
+
+        bool valid = header.magic == PIPELINE_CACHE_FILE_MAGIC && header.version == PIPELINE_CACHE_FILE_VERSION;
+
+        valid = valid && header.vendor_id == properties.vendorID && header.device_id == properties.deviceID && header.driver_version == properties.driverVersion;
+        valid = valid && memcmp(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        valid = valid && header.data_size == file.size() - sizeof(header) && header.data_hash == fast_hash(data, size_t(header.data_size));
+        valid = valid && driver_header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && driver_header.vendorID == properties.vendorID && driver_header.deviceID == properties.deviceID;
+        valid = valid && memcmp(driver_header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+
+        if (valid)
+        {
+            initial_data      = data;
+            initial_data_size = size_t(header.data_size);
+        }
+        else
+            INFERNO_LOG_WARNING("(Vulkan) Pipeline cache file is stale or corrupt, starting with an empty cache.");
+    }
+
+    VkPipelineCacheCreateInfo cache_info;
+    INFERNO_ZERO_MEMORY(cache_info);
+
+    cache_info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = initial_data_size;
+    cache_info.pInitialData    = initial_data;
+
+    if (vkCreatePipelineCache(m_vk_device, &cache_info, nullptr, &m_vk_pipeline_cache) != VK_SUCCESS)
+    {
+        // Not fatal, pipelines are simply created without a cache.
+        INFERNO_LOG_ERROR("(Vulkan) Failed to create Pipeline Cache.");
+        m_vk_pipeline_cache = nullptr;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Backend::save_pipeline_cache()
+{
+    size_t data_size = 0;
+
+    if (vkGetPipelineCacheData(m_vk_device, m_vk_pipeline_cache, &data_size, nullptr) != VK_SUCCESS || data_size == 0)
+        return;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_vk_physical_device, &properties);
+
+    std::vector<uint8_t> file(sizeof(PipelineCacheFileHeader) + data_size);
+    uint8_t*             data = file.data() + sizeof(PipelineCacheFileHeader);
+
+    if (vkGetPipelineCacheData(m_vk_device, m_vk_pipeline_cache, &data_size, data) != VK_SUCCESS)
+        return;
+
+    PipelineCacheFileHeader header;
+    INFERNO_ZERO_MEMORY(header);
+
+    header.magic          = PIPELINE_CACHE_FILE_MAGIC;
+    header.version        = PIPELINE_CACHE_FILE_VERSION;
+    header.vendor_id      = properties.vendorID;
+    header.device_id      = properties.deviceID;
+    header.driver_version = properties.driverVersion;
+    header.data_size      = data_size;
+    header.data_hash      = fast_hash(data, data_size);
+
+    memcpy(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    memcpy(file.data(), &header, sizeof(header));
+
+    // Written to a temporary file first so that a crash half way through never leaves a truncated cache behind.
+    std::string path      = utility::path_for_resource(PIPELINE_CACHE_FILE);
+    std::string temp_path = path + ".tmp";
+
+    if (!utility::write_binary(temp_path, file.data(), sizeof(header) + data_size))
+    {
+        INFERNO_LOG_ERROR("(Vulkan) Failed to write Pipeline Cache.");
+        remove(temp_path.c_str());
+        return;
+    }
+
+#if defined(_WIN32)
+    // rename() can't replace an existing file on Windows. Everywhere else it replaces the old cache atomically.
+    remove(path.c_str());
+#endif
+
+    if (rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        INFERNO_LOG_ERROR("(Vulkan) Failed to write Pipeline Cache.");
+        remove(temp_path.c_str());
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 void Backend::create_render_pass(std::shared_ptr<Backend> backend)
 {
     std::vector<VkAttachmentDescription> attachments(2);
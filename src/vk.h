@@ -1,10 +1,22 @@
 #pragma once
 
+#include "handle_pool.h"
+#include "small_vector.h"
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <string>
 #include <memory>
 
+#define MAX_SHADER_ENTRY_NAME_SIZE 32
+#define MAX_DESCRIPTOR_SET_LAYOUT_BINDINGS 32
+#define MAX_PIPELINE_DESCRIPTOR_SET_LAYOUTS 8
+#define MAX_PUSH_CONSTANT_RANGES 8
+#define MAX_DESCRIPTOR_POOL_SIZES 16
+// Upper bound for the frames the CPU may record ahead of the GPU. The actual count is passed to Backend::create().
+#define MAX_FRAMES_IN_FLIGHT 3
+// Pipeline cache contents are loaded from and saved to this file, resolved through utility::path_for_resource().
+#define PIPELINE_CACHE_FILE "pipeline_cache.bin"
+
 struct GLFWwindow;
 struct VmaAllocator_T;
 struct VmaAllocation_T;
@@ -49,18 +61,54 @@ struct QueueInfos
     bool transfer();
 };
 
+// Everything one frame in flight owns. The fence is signalled once the GPU has finished the frame, after which its command pool
+// is reset and reused. Transient CPU memory for the frame comes from frame_allocator, which recycles its regions on the same
+// cadence.
+struct FrameContext
+{
+    VkFence         vk_fence           = nullptr;
+    VkSemaphore     vk_image_available = nullptr;
+    VkSemaphore     vk_render_finished = nullptr;
+    VkCommandPool   vk_command_pool    = nullptr;
+    VkCommandBuffer vk_command_buffer  = nullptr;
+    uint32_t        image_index        = 0;
+    uint64_t        frame_number       = 0;
+};
+
 class Backend
 {
 public:
     using Ptr = std::shared_ptr<Backend>;
 
-    static Backend::Ptr create(GLFWwindow* window, bool enable_validation_layers = false);
+    static Backend::Ptr create(GLFWwindow* window, bool enable_validation_layers = false, uint32_t frames_in_flight = 2);
 
     ~Backend();
 
-    VkDevice        device();
-    VmaAllocator_T* allocator();
-    VkFormat        find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+    // Waits until the GPU has finished the frame that last used this context, which only blocks if the CPU is more than
+    // frames_in_flight frames ahead, then acquires the next swap chain image and begins the frame's command buffer.
+    FrameContext& begin_frame();
+
+    // Submits the frame's command buffer to the graphics queue and presents. The submission additionally waits on
+    // 'wait_semaphores', e.g. from uploads or async compute. Recreates the swap chain if it went out of date.
+    void end_frame(uint32_t wait_count = 0, const VkSemaphore* wait_semaphores = nullptr, const VkPipelineStageFlags* wait_stages = nullptr);
+
+    void wait_idle();
+
+    std::shared_ptr<Framebuffer> swap_chain_framebuffer(uint32_t image_index);
+    std::shared_ptr<RenderPass>  swap_chain_render_pass();
+    VkExtent2D                   swap_chain_extent();
+    uint32_t                     frames_in_flight();
+
+    VkDevice         device();
+    VmaAllocator_T*  allocator();
+    VkQueue          graphics_queue();
+    VkQueue          compute_queue();
+    VkQueue          transfer_queue();
+    QueueInfos&      queue_infos();
+    VkPhysicalDevice physical_device();
+    VkPipelineCache  pipeline_cache();
+    bool             descriptor_indexing();
+    VkFormat         find_supported_format(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
 private:
     Backend(GLFWwindow* window, bool enable_validation_layers = false);
@@ -77,7 +125,13 @@ private:
     bool                     find_queues(VkPhysicalDevice device, QueueInfos& infos);
     bool                     is_queue_compatible(VkQueueFlags current_queue_flags, int32_t graphics, int32_t compute, int32_t transfer);
     bool                     create_logical_device();
+    bool                     check_descriptor_indexing_support(VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features);
     bool                     create_swapchain(std::shared_ptr<Backend> backend);
+    void                     destroy_swapchain();
+    void                     recreate_swapchain();
+    void                     create_frame_contexts(uint32_t frames_in_flight);
+    void                     create_pipeline_cache();
+    void                     save_pipeline_cache();
     void                     create_render_pass(std::shared_ptr<Backend> backend);
     VkSurfaceFormatKHR       choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR>& available_formats);
     VkPresentModeKHR         choose_swap_present_mode(const std::vector<VkPresentModeKHR>& available_modes);
@@ -96,6 +150,8 @@ private:
     VkSwapchainKHR                            m_vk_swap_chain         = nullptr;
     VkDebugUtilsMessengerEXT                  m_vk_debug_messenger    = nullptr;
     VmaAllocator_T*                           m_vma_allocator         = nullptr;
+    VkPipelineCache                           m_vk_pipeline_cache     = nullptr;
+    bool                                      m_descriptor_indexing   = false;
     SwapChainSupportDetails                   m_swapchain_details;
     QueueInfos                                m_selected_queues;
     VkFormat                                  m_swap_chain_image_format;
@@ -107,21 +163,37 @@ private:
     std::vector<std::shared_ptr<Framebuffer>> m_swap_chain_framebuffers;
     std::shared_ptr<Image>                    m_swap_chain_depth      = nullptr;
     std::shared_ptr<ImageView>                m_swap_chain_depth_view = nullptr;
+    std::weak_ptr<Backend>                    m_self;
+    FrameContext                              m_frames[MAX_FRAMES_IN_FLIGHT];
+    std::vector<VkFence>                      m_image_fences;
+    uint32_t                                  m_frames_in_flight = 0;
+    uint64_t                                  m_frame_number     = 0;
 };
 
+// Objects created through create() keep a weak reference to the Backend so that destroying them after it is caught. Pooled
+// objects drop that reference once they are constructed: the Resources that owns the pool also owns the Backend and destroys its
+// pools first, so they only hold the raw device and never touch a reference count.
 class Object
 {
 public:
-    Object(Backend::Ptr backend, VkDevice device = nullptr);
+    Object(Backend::Ptr backend);
+
+protected:
+    friend class Resources;
+
+    inline bool backend_destroyed() { return !m_pooled && m_vk_backend.expired(); }
 
 protected:
     std::weak_ptr<Backend> m_vk_backend;
+    VkDevice               m_vk_device = nullptr;
+    bool                   m_pooled    = false;
 };
 
 class Image : public Object
 {
 public:
-    using Ptr = std::shared_ptr<Image>;
+    using Ptr    = std::shared_ptr<Image>;
+    using Handle = inferno::Handle<Image>;
 
     static Image::Ptr create(Backend::Ptr backend, VkImageType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t mip_levels, uint32_t array_size, VkFormat format, VmaMemoryUsage memory_usage, VkImageUsageFlagBits usage, VkSampleCountFlagBits sample_count, VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED);
     static Image::Ptr create_from_swapchain(Backend::Ptr backend, VkImage image, VkImageType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t mip_levels, uint32_t array_size, VkFormat format, VmaMemoryUsage memory_usage, VkImageUsageFlagBits usage, VkSampleCountFlagBits sample_count);
@@ -141,6 +213,8 @@ public:
     inline VkSampleCountFlags sample_count() { return m_sample_count; }
 
 private:
+    friend class HandlePool<Image>;
+
     Image(Backend::Ptr backend, VkImageType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t mip_levels, uint32_t array_size, VkFormat format, VmaMemoryUsage memory_usage, VkImageUsageFlagBits usage, VkSampleCountFlagBits sample_count, VkImageLayout initial_layout);
     Image(Backend::Ptr backend, VkImage image, VkImageType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t mip_levels, uint32_t array_size, VkFormat format, VmaMemoryUsage memory_usage, VkImageUsageFlagBits usage, VkSampleCountFlagBits sample_count);
 
@@ -164,51 +238,67 @@ private:
 class ImageView : public Object
 {
 public:
-    using Ptr = std::shared_ptr<ImageView>;
+    using Ptr    = std::shared_ptr<ImageView>;
+    using Handle = inferno::Handle<ImageView>;
 
     static ImageView::Ptr create(Backend::Ptr backend, Image::Ptr image, VkImageViewType view_type, VkImageAspectFlags aspect_flags, uint32_t base_mip_level = 0, uint32_t level_count = 1, uint32_t base_array_layer = 0, uint32_t layer_count = 1);
 
     ~ImageView();
 
     inline VkImageView handle() { return m_vk_image_view; }
+    // Unique for the lifetime of the process, unlike the handle which may be reused once the view is destroyed.
+    inline uint64_t id() { return m_id; }
 
 private:
-    ImageView(Backend::Ptr backend, Image::Ptr image, VkImageViewType view_type, VkImageAspectFlags aspect_flags, uint32_t base_mip_level = 0, uint32_t level_count = 1, uint32_t base_array_layer = 0, uint32_t layer_count = 1);
+    friend class HandlePool<ImageView>;
+
+    ImageView(Backend::Ptr backend, Image* image, VkImageViewType view_type, VkImageAspectFlags aspect_flags, uint32_t base_mip_level = 0, uint32_t level_count = 1, uint32_t base_array_layer = 0, uint32_t layer_count = 1);
 
 private:
     VkImageView m_vk_image_view;
+    uint64_t    m_id;
 };
 
 class RenderPass : public Object
 {
 public:
-    using Ptr = std::shared_ptr<RenderPass>;
+    using Ptr    = std::shared_ptr<RenderPass>;
+    using Handle = inferno::Handle<RenderPass>;
 
-    static RenderPass::Ptr create(Backend::Ptr backend, std::vector<VkAttachmentDescription> attachment_descs, std::vector<VkSubpassDescription> subpass_descs, std::vector<VkSubpassDependency> subpass_deps);
+    static RenderPass::Ptr create(Backend::Ptr backend, const std::vector<VkAttachmentDescription>& attachment_descs, const std::vector<VkSubpassDescription>& subpass_descs, const std::vector<VkSubpassDependency>& subpass_deps);
     ~RenderPass();
 
     inline VkRenderPass handle() { return m_vk_render_pass; }
+    // Equal for render passes that are compatible in the Vulkan sense, i.e. that can be used with the same pipelines and
+    // framebuffers. Ignores load/store ops and layouts.
+    inline uint64_t compatibility_hash() { return m_compatibility_hash; }
 
 private:
-    RenderPass(Backend::Ptr backend, std::vector<VkAttachmentDescription> attachment_descs, std::vector<VkSubpassDescription> subpass_descs, std::vector<VkSubpassDependency> subpass_deps);
+    friend class HandlePool<RenderPass>;
+
+    RenderPass(Backend::Ptr backend, const std::vector<VkAttachmentDescription>& attachment_descs, const std::vector<VkSubpassDescription>& subpass_descs, const std::vector<VkSubpassDependency>& subpass_deps);
 
 private:
-    VkRenderPass m_vk_render_pass = nullptr;
+    VkRenderPass m_vk_render_pass     = nullptr;
+    uint64_t     m_compatibility_hash = 0;
 };
 
 class Framebuffer : public Object
 {
 public:
-    using Ptr = std::shared_ptr<Framebuffer>;
+    using Ptr    = std::shared_ptr<Framebuffer>;
+    using Handle = inferno::Handle<Framebuffer>;
 
-    static Framebuffer::Ptr create(Backend::Ptr backend, RenderPass::Ptr render_pass, std::vector<ImageView::Ptr> views, uint32_t width, uint32_t height, uint32_t layers);
+    static Framebuffer::Ptr create(Backend::Ptr backend, RenderPass::Ptr render_pass, const std::vector<ImageView::Ptr>& views, uint32_t width, uint32_t height, uint32_t layers);
 
     ~Framebuffer();
 
     inline VkFramebuffer handle() { return m_vk_framebuffer; }
 
 private:
-    Framebuffer(Backend::Ptr backend, RenderPass::Ptr render_pass, std::vector<ImageView::Ptr> views, uint32_t width, uint32_t height, uint32_t layers);
+    friend class HandlePool<Framebuffer>;
+
+    Framebuffer(Backend::Ptr backend, RenderPass* render_pass, ImageView* const* views, uint32_t view_count, uint32_t width, uint32_t height, uint32_t layers);
 
 private:
     VkFramebuffer m_vk_framebuffer;
@@ -217,26 +307,31 @@ private:
 class Buffer : public Object
 {
 public:
-    using Ptr = std::shared_ptr<Buffer>;
+    using Ptr    = std::shared_ptr<Buffer>;
+    using Handle = inferno::Handle<Buffer>;
 
     static Buffer::Ptr create(Backend::Ptr backend, VkBufferUsageFlags usage, size_t size, VmaMemoryUsage memory_usage, VkFlags create_flags);
 
     ~Buffer();
 
-    inline VkBuffer handle() { return m_vk_buffer; }
-    inline size_t   size() { return m_size; }
-    inline void*    mapped_ptr() { return m_mapped_ptr; }
+    inline VkBuffer              handle() { return m_vk_buffer; }
+    inline size_t                size() { return m_size; }
+    inline void*                 mapped_ptr() { return m_mapped_ptr; }
+    inline VkMemoryPropertyFlags memory_properties() { return m_memory_properties; }
 
 private:
+    friend class HandlePool<Buffer>;
+
     Buffer(Backend::Ptr backend, VkBufferUsageFlags usage, size_t size, VmaMemoryUsage memory_usage, VkFlags create_flags);
 
 private:
-    size_t           m_size;
-    void*            m_mapped_ptr       = nullptr;
-    VkBuffer         m_vk_buffer        = nullptr;
-    VkDeviceMemory   m_vk_device_memory = nullptr;
-    VmaAllocator_T*  m_vma_allocator    = nullptr;
-    VmaAllocation_T* m_vma_allocation   = nullptr;
+    size_t                m_size;
+    void*                 m_mapped_ptr        = nullptr;
+    VkBuffer              m_vk_buffer         = nullptr;
+    VkDeviceMemory        m_vk_device_memory  = nullptr;
+    VkMemoryPropertyFlags m_memory_properties = 0;
+    VmaAllocator_T*       m_vma_allocator     = nullptr;
+    VmaAllocation_T*      m_vma_allocation    = nullptr;
 };
 
 class CommandPool : public Object
@@ -280,19 +375,25 @@ private:
 class ShaderModule : public Object
 {
 public:
-    using Ptr = std::shared_ptr<ShaderModule>;
+    using Ptr    = std::shared_ptr<ShaderModule>;
+    using Handle = inferno::Handle<ShaderModule>;
 
-    static ShaderModule::Ptr create(Backend::Ptr backend, std::vector<uint32_t> spirv);
+    static ShaderModule::Ptr create(Backend::Ptr backend, const std::vector<uint32_t>& spirv);
 
     ~ShaderModule();
 
     inline VkShaderModule handle() { return m_vk_module; }
+    // Hash of the SPIR-V, identifies the shader independently of the module handle.
+    inline uint64_t hash() { return m_hash; }
 
 private:
-    ShaderModule(Backend::Ptr backend, std::vector<uint32_t> spirv);
+    friend class HandlePool<ShaderModule>;
+
+    ShaderModule(Backend::Ptr backend, const std::vector<uint32_t>& spirv);
 
 private:
-    VkShaderModule m_vk_module;
+    VkShaderModule m_vk_module = nullptr;
+    uint64_t       m_hash      = 0;
 };
 
 struct VertexInputStateDesc
@@ -416,38 +517,56 @@ struct ColorBlendStateDesc
 class GraphicsPipeline : public Object
 {
 public:
-    using Ptr = std::shared_ptr<GraphicsPipeline>;
+    using Ptr    = std::shared_ptr<GraphicsPipeline>;
+    using Handle = inferno::Handle<GraphicsPipeline>;
 
+    // Self-contained: the state descs are copied in, and the pointers between them are only resolved when the pipeline is
+    // created, so a Desc can be copied and stored freely.
     struct Desc
     {
-        VkGraphicsPipelineCreateInfo    create_info;
-        uint32_t                        shader_stage_count = 0;
-        VkPipelineShaderStageCreateInfo shader_stages[6];
-        std::string                     shader_entry_names[6];
+        VkGraphicsPipelineCreateInfo            create_info;
+        uint32_t                                shader_stage_count = 0;
+        VkPipelineShaderStageCreateInfo         shader_stages[6];
+        FixedString<MAX_SHADER_ENTRY_NAME_SIZE> shader_entry_names[6];
+        uint64_t                                shader_hashes[6];
+        uint64_t                                render_pass_hash = 0;
+        VertexInputStateDesc                    vertex_input_state;
+        InputAssemblyStateDesc                  input_assembly_state;
+        TessellationStateDesc                   tessellation_state;
+        RasterizationStateDesc                  rasterization_state;
+        MultisampleStateDesc                    multisample_state;
+        DepthStencilStateDesc                   depth_stencil_state;
+        ColorBlendStateDesc                     color_blend_state;
 
         Desc();
-        Desc& add_shader_stage(VkShaderStageFlagBits stage, ShaderModule::Ptr shader_module, std::string name);
-        Desc& set_input_assembly_state(InputAssemblyStateDesc state);
-        Desc& set_tessellation_state(TessellationStateDesc state);
-        Desc& set_rasterization_state(RasterizationStateDesc state);
-        Desc& set_multisample_state(MultisampleStateDesc state);
-        Desc& set_depth_stencil_state(DepthStencilStateDesc state);
-        Desc& set_color_blend_state(ColorBlendStateDesc state);
+        Desc& add_shader_stage(VkShaderStageFlagBits stage, ShaderModule::Ptr shader_module, const char* name);
+        Desc& add_shader_stage(VkShaderStageFlagBits stage, ShaderModule* shader_module, const char* name);
+        Desc& set_vertex_input_state(const VertexInputStateDesc& state);
+        Desc& set_input_assembly_state(const InputAssemblyStateDesc& state);
+        Desc& set_tessellation_state(const TessellationStateDesc& state);
+        Desc& set_rasterization_state(const RasterizationStateDesc& state);
+        Desc& set_multisample_state(const MultisampleStateDesc& state);
+        Desc& set_depth_stencil_state(const DepthStencilStateDesc& state);
+        Desc& set_color_blend_state(const ColorBlendStateDesc& state);
         Desc& set_pipeline_layout(std::shared_ptr<PipelineLayout> layout);
+        Desc& set_pipeline_layout(PipelineLayout* layout);
         Desc& set_render_pass(RenderPass::Ptr render_pass);
+        Desc& set_render_pass(RenderPass* render_pass);
         Desc& set_sub_pass(uint32_t subpass);
         Desc& set_base_pipeline(GraphicsPipeline::Ptr pipeline);
         Desc& set_base_pipeline_index(int32_t index);
     };
 
-    static GraphicsPipeline::Ptr create(Backend::Ptr backend, Desc desc);
+    static GraphicsPipeline::Ptr create(Backend::Ptr backend, const Desc& desc);
 
     inline VkPipeline handle() { return m_vk_pipeline; }
 
     ~GraphicsPipeline();
 
 private:
-    GraphicsPipeline(Backend::Ptr backend, Desc desc);
+    friend class HandlePool<GraphicsPipeline>;
+
+    GraphicsPipeline(Backend::Ptr backend, const Desc& desc);
 
 private:
     VkPipeline m_vk_pipeline;
@@ -456,28 +575,34 @@ private:
 class ComputePipeline : public Object
 {
 public:
-    using Ptr = std::shared_ptr<ComputePipeline>;
+    using Ptr    = std::shared_ptr<ComputePipeline>;
+    using Handle = inferno::Handle<ComputePipeline>;
 
     struct Desc
     {
-        VkComputePipelineCreateInfo create_info;
-        std::string                 shader_entry_name;
+        VkComputePipelineCreateInfo             create_info;
+        FixedString<MAX_SHADER_ENTRY_NAME_SIZE> shader_entry_name;
+        uint64_t                                shader_hash = 0;
 
         Desc();
-        Desc& set_shader_stage(ShaderModule::Ptr shader_module, std::string name);
+        Desc& set_shader_stage(ShaderModule::Ptr shader_module, const char* name);
+        Desc& set_shader_stage(ShaderModule* shader_module, const char* name);
         Desc& set_pipeline_layout(std::shared_ptr<PipelineLayout> layout);
+        Desc& set_pipeline_layout(PipelineLayout* layout);
         Desc& set_base_pipeline(ComputePipeline::Ptr pipeline);
         Desc& set_base_pipeline_index(int32_t index);
     };
 
-    static ComputePipeline::Ptr create(Backend::Ptr backend, Desc desc);
+    static ComputePipeline::Ptr create(Backend::Ptr backend, const Desc& desc);
 
     inline VkPipeline handle() { return m_vk_pipeline; }
 
     ~ComputePipeline();
 
 private:
-    ComputePipeline(Backend::Ptr backend, Desc desc);
+    friend class HandlePool<ComputePipeline>;
+
+    ComputePipeline(Backend::Ptr backend, const Desc& desc);
 
 private:
     VkPipeline m_vk_pipeline;
@@ -486,7 +611,8 @@ private:
 class Sampler : public Object
 {
 public:
-    using Ptr = std::shared_ptr<Sampler>;
+    using Ptr    = std::shared_ptr<Sampler>;
+    using Handle = inferno::Handle<Sampler>;
 
     struct Desc
     {
@@ -510,12 +636,14 @@ public:
 
     inline VkSampler handle() { return m_vk_sampler; }
 
-    static Sampler::Ptr create(Backend::Ptr backend, Desc desc);
+    static Sampler::Ptr create(Backend::Ptr backend, const Desc& desc);
 
     ~Sampler();
 
 private:
-    Sampler(Backend::Ptr backend, Desc desc);
+    friend class HandlePool<Sampler>;
+
+    Sampler(Backend::Ptr backend, const Desc& desc);
 
 private:
     VkSampler m_vk_sampler;
@@ -524,25 +652,33 @@ private:
 class DescriptorSetLayout : public Object
 {
 public:
-    using Ptr = std::shared_ptr<DescriptorSetLayout>;
+    using Ptr    = std::shared_ptr<DescriptorSetLayout>;
+    using Handle = inferno::Handle<DescriptorSetLayout>;
 
     struct Desc
     {
-        std::vector<VkDescriptorSetLayoutBinding> bindings;
-        VkSampler                                 binding_samplers[32][8];
+        VkDescriptorSetLayoutCreateFlags                                            flags = 0;
+        SmallVector<VkDescriptorSetLayoutBinding, MAX_DESCRIPTOR_SET_LAYOUT_BINDINGS> bindings;
+        SmallVector<VkDescriptorBindingFlagsEXT, MAX_DESCRIPTOR_SET_LAYOUT_BINDINGS>  binding_flags;
+        VkSampler                                                                   binding_samplers[MAX_DESCRIPTOR_SET_LAYOUT_BINDINGS][8];
 
+        Desc& set_flags(VkDescriptorSetLayoutCreateFlags value);
         Desc& add_binding(uint32_t binding, VkDescriptorType descriptor_type, uint32_t descriptor_count, VkShaderStageFlags stage_flags);
         Desc& add_binding(uint32_t binding, VkDescriptorType descriptor_type, uint32_t descriptor_count, VkShaderStageFlags stage_flags, Sampler::Ptr samplers[]);
+        // Requires Backend::descriptor_indexing(), e.g. for partially bound or update-after-bind arrays.
+        Desc& set_binding_flags(uint32_t binding, VkDescriptorBindingFlagsEXT value);
     };
 
-    static DescriptorSetLayout::Ptr create(Backend::Ptr backend, Desc desc);
+    static DescriptorSetLayout::Ptr create(Backend::Ptr backend, const Desc& desc);
 
     ~DescriptorSetLayout();
 
     inline VkDescriptorSetLayout handle() { return m_vk_ds_layout; }
 
 private:
-    DescriptorSetLayout(Backend::Ptr backend, Desc desc);
+    friend class HandlePool<DescriptorSetLayout>;
+
+    DescriptorSetLayout(Backend::Ptr backend, const Desc& desc);
 
 private:
     VkDescriptorSetLayout m_vk_ds_layout;
@@ -551,25 +687,29 @@ private:
 class PipelineLayout : public Object
 {
 public:
-    using Ptr = std::shared_ptr<PipelineLayout>;
+    using Ptr    = std::shared_ptr<PipelineLayout>;
+    using Handle = inferno::Handle<PipelineLayout>;
 
     struct Desc
     {
-        std::vector<DescriptorSetLayout::Ptr> layouts;
-        std::vector<VkPushConstantRange>      push_constant_ranges;
+        SmallVector<VkDescriptorSetLayout, MAX_PIPELINE_DESCRIPTOR_SET_LAYOUTS> layouts;
+        SmallVector<VkPushConstantRange, MAX_PUSH_CONSTANT_RANGES>              push_constant_ranges;
 
         Desc& add_descriptor_set_layout(DescriptorSetLayout::Ptr layout);
+        Desc& add_descriptor_set_layout(DescriptorSetLayout* layout);
         Desc& add_push_constant_range(VkShaderStageFlags stage_flags, uint32_t offset, uint32_t size);
     };
 
-    static PipelineLayout::Ptr create(Backend::Ptr backend, Desc desc);
+    static PipelineLayout::Ptr create(Backend::Ptr backend, const Desc& desc);
 
     ~PipelineLayout();
 
     inline VkPipelineLayout handle() { return m_vk_pipeline_layout; }
 
 private:
-    PipelineLayout(Backend::Ptr backend, Desc desc);
+    friend class HandlePool<PipelineLayout>;
+
+    PipelineLayout(Backend::Ptr backend, const Desc& desc);
 
 private:
     VkPipelineLayout m_vk_pipeline_layout;
@@ -582,21 +722,23 @@ public:
 
     struct Desc
     {
-        uint32_t                          max_sets;
-        std::vector<VkDescriptorPoolSize> pool_sizes;
+        VkDescriptorPoolCreateFlags                                  flags    = 0;
+        uint32_t                                                     max_sets = 0;
+        SmallVector<VkDescriptorPoolSize, MAX_DESCRIPTOR_POOL_SIZES> pool_sizes;
 
+        Desc& set_flags(VkDescriptorPoolCreateFlags value);
         Desc& set_max_sets(uint32_t num);
         Desc& add_pool_size(VkDescriptorType type, uint32_t descriptor_count);
     };
 
-    static DescriptorPool::Ptr create(Backend::Ptr backend, Desc desc);
+    static DescriptorPool::Ptr create(Backend::Ptr backend, const Desc& desc);
 
     ~DescriptorPool();
 
     inline VkDescriptorPool handle() { return m_vk_ds_pool; }
 
 private:
-    DescriptorPool(Backend::Ptr backend, Desc desc);
+    DescriptorPool(Backend::Ptr backend, const Desc& desc);
 
 private:
     VkDescriptorPool m_vk_ds_pool;
@@ -621,5 +763,93 @@ private:
     std::weak_ptr<DescriptorPool> m_vk_pool;
 };
 
+// Typed handle pools for the Vulkan objects that get created once and then referenced every frame. Objects live inside the pools
+// instead of behind individual shared_ptrs, and code that refers to them passes 32-bit handles around instead of reference
+// counted pointers. Lifetime is explicit: an object is destroyed by release() or when the Resources object goes away. Pools are
+// destroyed in reverse dependency order, so pipelines go before their layouts and framebuffers before their views and images.
+// Keeps the Backend alive for as long as any pooled object exists. Not thread-safe.
+//
+//     Image::Handle     image = resources->allocate<Image>(VK_IMAGE_TYPE_2D, w, h, 1, 1, 1, format, ...);
+//     ImageView::Handle view  = resources->allocate<ImageView>(resources->get(image), VK_IMAGE_VIEW_TYPE_2D, aspect);
+class Resources
+{
+public:
+    using Ptr = std::shared_ptr<Resources>;
+
+    static Resources::Ptr create(Backend::Ptr backend);
+
+    ~Resources();
+
+    // Constructs a T in its pool with the arguments of its create() function minus the backend.
+    template <typename T, typename... Args>
+    inferno::Handle<T> allocate(Args&&... args)
+    {
+        inferno::Handle<T> handle = pool<T>().allocate(m_backend, std::forward<Args>(args)...);
+        Object*            object = pool<T>().get(handle);
+
+        object->m_vk_backend.reset();
+        object->m_pooled = true;
+
+        return handle;
+    }
+
+    // Returns nullptr for null, stale or released handles.
+    template <typename T>
+    inline T* get(inferno::Handle<T> handle)
+    {
+        return pool<T>().get(handle);
+    }
+
+    template <typename T>
+    inline void release(inferno::Handle<T> handle)
+    {
+        pool<T>().release(handle);
+    }
+
+private:
+    Resources(Backend::Ptr backend);
+
+    template <typename T>
+    HandlePool<T>& pool();
+
+private:
+    // Declared first so that every pool, and with it every pooled object, is destroyed before the Backend can be.
+    Backend::Ptr                    m_backend;
+    HandlePool<Image>               m_images;
+    HandlePool<ImageView>           m_image_views;
+    HandlePool<Buffer>              m_buffers;
+    HandlePool<Sampler>             m_samplers;
+    HandlePool<ShaderModule>        m_shader_modules;
+    HandlePool<RenderPass>          m_render_passes;
+    HandlePool<Framebuffer>         m_framebuffers;
+    HandlePool<DescriptorSetLayout> m_descriptor_set_layouts;
+    HandlePool<PipelineLayout>      m_pipeline_layouts;
+    HandlePool<GraphicsPipeline>    m_graphics_pipelines;
+    HandlePool<ComputePipeline>     m_compute_pipelines;
+};
+
+template <>
+inline HandlePool<Image>& Resources::pool<Image>() { return m_images; }
+template <>
+inline HandlePool<ImageView>& Resources::pool<ImageView>() { return m_image_views; }
+template <>
+inline HandlePool<Buffer>& Resources::pool<Buffer>() { return m_buffers; }
+template <>
+inline HandlePool<Sampler>& Resources::pool<Sampler>() { return m_samplers; }
+template <>
+inline HandlePool<ShaderModule>& Resources::pool<ShaderModule>() { return m_shader_modules; }
+template <>
+inline HandlePool<RenderPass>& Resources::pool<RenderPass>() { return m_render_passes; }
+template <>
+inline HandlePool<Framebuffer>& Resources::pool<Framebuffer>() { return m_framebuffers; }
+template <>
+inline HandlePool<DescriptorSetLayout>& Resources::pool<DescriptorSetLayout>() { return m_descriptor_set_layouts; }
+template <>
+inline HandlePool<PipelineLayout>& Resources::pool<PipelineLayout>() { return m_pipeline_layouts; }
+template <>
+inline HandlePool<GraphicsPipeline>& Resources::pool<GraphicsPipeline>() { return m_graphics_pipelines; }
+template <>
+inline HandlePool<ComputePipeline>& Resources::pool<ComputePipeline>() { return m_compute_pipelines; }
+
 } // namespace vk
 } // namespace inferno
\ No newline at end of file